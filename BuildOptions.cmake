@@ -54,9 +54,21 @@ else ()
     option(SN_CONFIG_NO_TESTING_SUITE "Disable the test suite if set" ON)
 endif ()
 
+option(SN_CONFIG_BUILD_BENCHMARKS "Build the micro benchmarks under Testing/benchmarks" OFF)
+
+option(SN_CONFIG_BUILD_PRELOAD "Build libsafetynet_preload.so, an LD_PRELOAD malloc interposer for whole process tracking (glibc only)" OFF)
+
 option(SN_NO_STD_BOOL "Does not uses stdbool.h" OFF)
 
-option(SN_CONFIG_SANITIZE_MEMORY_ON_FREE "pressure wash the block of memory with zeros on free" ON)
+option(SN_CONFIG_SANITIZE_MEMORY_ON_FREE "pressure wash the block of memory with zeros on free by default (changed at runtime with sn_set_sanitize_policy)" ON)
+
+set(SN_CONFIG_REGISTRY_SHARD_COUNT 16 CACHE STRING "How many address hashed shards the block registry is split into (power of two)")
+
+set(SN_CONFIG_FAST_CACHE_SLOTS 64 CACHE STRING "How many blocks the fast cache holds at startup (rounded up to a power of two, changed at runtime with sn_set_fast_cache_size)")
+
+option(SN_CONFIG_ENABLE_THREAD_CACHE "Compile in the per thread cache of freed small blocks (toggled at runtime with sn_do_thread_cache)" ON)
+
+option(SN_CONFIG_ENABLE_INLINE_HEADER "Compile in the inline block header tracking mode (toggled at runtime with sn_do_inline_headers)" ON)
 
 # Debug flag control
 option(SN_CONFIG_DEBUG "Enable debug mode" ON)
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Worker threads that keep querying the same few buffers, each thread its own
+// Those lookups should be answered by the thread's own lookup cache without touching shared state
+
+#include "libsafetynet.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+int main(int argc, char** argv)
+{
+    std::size_t max_threads = 8;
+    if (argc > 1) max_threads = std::strtoull(argv[1], nullptr, 10);
+
+    constexpr std::size_t buffers_per_thread = 8;
+    constexpr std::size_t queries_per_thread = 2'000'000;
+
+    std::printf("%8s %16s %16s\n", "threads", "query_ns/op", "Mqueries/s");
+
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::vector<std::thread> workers;
+        const auto start = bench_clock::now();
+        for (std::size_t t = 0; t < threads; t++)
+        {
+            workers.emplace_back([]
+            {
+                void* buffers[buffers_per_thread];
+                for (auto& buffer : buffers)
+                    buffer = sn_malloc(4096);
+
+                volatile std::size_t sink = 0;
+                for (std::size_t i = 0; i < queries_per_thread; i++)
+                    sink = sink + sn_query_size(buffers[i % buffers_per_thread]);
+
+                for (auto& buffer : buffers)
+                    sn_free(buffer);
+                (void)sink;
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count());
+        const double ops = static_cast<double>(threads * queries_per_thread);
+        std::printf("%8zu %16.1f %16.2f\n", threads, ns / ops, ops / ns * 1000.0);
+    }
+
+    return 0;
+}
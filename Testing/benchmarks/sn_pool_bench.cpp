@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Fixed size objects churned through sn_malloc/sn_free against an sn_pool
+
+#include "libsafetynet.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+static double ns_per_op(bench_clock::time_point start, bench_clock::time_point end, std::size_t ops)
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / static_cast<double>(ops);
+}
+
+// Keeps a live set of count objects and replaces one per op, in a fixed stride order
+template<class Alloc, class Free>
+static double churn(std::size_t count, std::size_t ops, Alloc alloc, Free release)
+{
+    std::vector<void*> live(count);
+    for (void*& object : live)
+        object = alloc();
+
+    const auto start = bench_clock::now();
+    for (std::size_t i = 0; i < ops; i++)
+    {
+        void*& object = live[(i * 7919) % count];
+        release(object);
+        object = alloc();
+    }
+    const auto end = bench_clock::now();
+
+    for (void* object : live)
+        release(object);
+    return ns_per_op(start, end, ops);
+}
+
+int main()
+{
+    constexpr std::size_t object_size = 192;
+    constexpr std::size_t live = 4096;
+    constexpr std::size_t ops = 2'000'000;
+
+    std::printf("%10s %14s %14s\n", "sanitize", "sn_malloc", "sn_pool");
+    for (const sn_sanitize_mode_e mode : {SN_SANITIZE_OFF, SN_SANITIZE_ON_FREE})
+    {
+        sn_set_sanitize_policy(mode, 0);
+
+        const double malloc_ns = churn(live, ops,
+            [] { return sn_malloc(object_size); },
+            [](void* object) { sn_free(object); });
+
+        sn_pool_t* pool = sn_pool_create(object_size, 256);
+        const double pool_ns = churn(live, ops,
+            [pool] { return sn_pool_alloc(pool); },
+            [pool](void* object) { sn_pool_free(pool, object); });
+        sn_pool_destroy(pool);
+
+        std::printf("%10s %14.1f %14.1f\n", mode == SN_SANITIZE_OFF ? "off" : "on_free", malloc_ns, pool_ns);
+    }
+    std::printf("(ns per free + alloc of a %zu byte object)\n", object_size);
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Plain malloc/realloc/free workloads, run once as is and once more under LD_PRELOAD=libsafetynet_preload.so
+// usage: sn_preload_bench path/to/libsafetynet_preload.so
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+using bench_clock = std::chrono::steady_clock;
+
+static double mops(bench_clock::time_point start, bench_clock::time_point end, std::size_t ops)
+{
+    return static_cast<double>(ops) / static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+}
+
+// Keeps the compiler from pairing up and dropping a malloc and free it can see
+static void* escape(void* block)
+{
+    asm volatile("" : "+r"(block) : : "memory");
+    return block;
+}
+
+static std::uint64_t next_random(std::uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// A live set of small blocks where every op frees a random one and allocates its replacement
+static void churn(std::size_t ops, std::uint64_t seed)
+{
+    constexpr std::size_t live = 1024;
+    std::vector<void*> slots(live, nullptr);
+    for (std::size_t i = 0; i < ops; i++)
+    {
+        const std::uint64_t r = next_random(seed);
+        void*& slot = slots[r % live];
+        std::free(slot);
+        slot = escape(std::malloc(16 + (r >> 32) % 241));
+    }
+    for (void* slot : slots)
+        std::free(slot);
+}
+
+static double churn_single(std::size_t ops)
+{
+    const auto start = bench_clock::now();
+    churn(ops, 0x9E3779B97F4A7C15ull);
+    return mops(start, bench_clock::now(), ops);
+}
+
+static double churn_threads(std::size_t ops, std::size_t threads)
+{
+    std::vector<std::thread> workers;
+    const auto start = bench_clock::now();
+    for (std::size_t t = 0; t < threads; t++)
+        workers.emplace_back(churn, ops / threads, 0x9E3779B97F4A7C15ull + t);
+    for (auto& worker : workers)
+        worker.join();
+    return mops(start, bench_clock::now(), ops);
+}
+
+// A buffer grown a bit at a time, like a string builder
+static double realloc_grow(std::size_t ops)
+{
+    const auto start = bench_clock::now();
+    std::size_t done = 0;
+    while (done < ops)
+    {
+        void* buffer = nullptr;
+        for (std::size_t size = 64; size <= 64 * 1024 && done < ops; size += 64, done++)
+            buffer = escape(std::realloc(buffer, size));
+        std::free(buffer);
+    }
+    return mops(start, bench_clock::now(), ops);
+}
+
+static void run(const char* label)
+{
+    constexpr std::size_t ops = 2'000'000;
+    std::printf("%-10s %14.2f %14.2f %14.2f\n", label, churn_single(ops), churn_threads(ops, 4), realloc_grow(ops / 4));
+}
+
+int main(int argc, char** argv)
+{
+    if (std::getenv("SN_PRELOAD_BENCH_CHILD"))
+    {
+        run("preload");
+        return 0;
+    }
+
+    std::printf("%-10s %14s %14s %14s\n", "malloc", "churn", "churn_4t", "realloc_grow");
+    run("glibc");
+    std::fflush(stdout);
+
+    if (argc < 2)
+    {
+        std::printf("(pass the path to libsafetynet_preload.so to compare)\n");
+        return 0;
+    }
+
+    std::string preload = std::string("LD_PRELOAD=") + argv[1];
+    std::vector<char*> env;
+    for (char** var = environ; *var; var++)
+        env.push_back(*var);
+    env.push_back(preload.data());
+    env.push_back(const_cast<char*>("SN_PRELOAD_BENCH_CHILD=1"));
+    env.push_back(nullptr);
+
+    pid_t child;
+    char* child_argv[] = {argv[0], nullptr};
+    if (posix_spawn(&child, "/proc/self/exe", nullptr, nullptr, child_argv, env.data()) != 0)
+    {
+        std::perror("posix_spawn");
+        return 1;
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    std::printf("(million ops per second)\n");
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Aggregate query throughput as threads are added, all of them looking at the same blocks
+// There are more blocks than a thread's lookup cache holds so every query reaches a registry shard
+// With an exclusive shard lock readers queue behind each other, under a reader-writer lock they shouldn't
+
+#include "libsafetynet.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+static void query(const std::vector<void*>* blocks, std::size_t ops, std::atomic<bool>* go, std::atomic<std::size_t>* sink)
+{
+    while (!go->load(std::memory_order_acquire))
+        std::this_thread::yield();
+
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < ops; i++)
+        total += sn_query_size((*blocks)[i % blocks->size()]);
+    sink->fetch_add(total, std::memory_order_relaxed);
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t max_threads = 16;
+    if (argc > 1) max_threads = std::strtoull(argv[1], nullptr, 10);
+
+    constexpr std::size_t ops_per_thread = 1'000'000;
+    constexpr std::size_t block_count = 1024;
+
+    std::vector<void*> blocks(block_count);
+    for (std::size_t i = 0; i < block_count; i++)
+        blocks[i] = sn_malloc(16 + i);
+
+    std::atomic<std::size_t> sink{0};
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    std::printf("%8s %16s %16s\n", "threads", "total_Mops/s", "per_thread");
+
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::atomic<bool> go{false};
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (std::size_t t = 0; t < threads; t++)
+            workers.emplace_back(query, &blocks, ops_per_thread, &go, &sink);
+
+        const auto start = bench_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers)
+            worker.join();
+        const double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+        const double mops = static_cast<double>(threads * ops_per_thread) / seconds / 1e6;
+        std::printf("%8zu %16.2f %16.2f\n", threads, mops, mops / static_cast<double>(threads));
+    }
+
+    for (void* block : blocks)
+        sn_free(block);
+    return sink.load() == 0; // Keeps the queries from being optimized out
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Measures sn_free/sn_query_size latency as the number of live tracked blocks grows
+// With the pointer index both should stay flat instead of growing with the registry
+
+#include "libsafetynet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+static double ns_per_op(bench_clock::time_point start, bench_clock::time_point end, std::size_t ops)
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / static_cast<double>(ops);
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t max_blocks = 2'000'000;
+    if (argc > 1) max_blocks = std::strtoull(argv[1], nullptr, 10);
+
+    constexpr std::size_t sample_ops = 10'000;
+    std::mt19937_64 rng(44);
+
+    std::printf("%12s %16s %16s\n", "live_blocks", "free_ns/op", "query_ns/op");
+
+    for (std::size_t live = 1'000; live <= max_blocks; live *= 10)
+    {
+        std::vector<void*> blocks(live);
+        for (auto& block : blocks)
+            block = sn_malloc(16);
+
+        std::vector<void*> sample;
+        std::sample(blocks.begin(), blocks.end(), std::back_inserter(sample), std::min(sample_ops, live), rng);
+
+        volatile std::size_t sink = 0;
+        auto start = bench_clock::now();
+        for (void* block : sample)
+            sink = sink + sn_query_size(block);
+        const double query_ns = ns_per_op(start, bench_clock::now(), sample.size());
+
+        start = bench_clock::now();
+        for (void* block : sample)
+            sn_free(block);
+        const double free_ns = ns_per_op(start, bench_clock::now(), sample.size());
+
+        std::printf("%12zu %16.1f %16.1f\n", live, free_ns, query_ns);
+
+        std::sort(sample.begin(), sample.end());
+        for (void* block : blocks)
+        {
+            if (!std::binary_search(sample.begin(), sample.end(), block))
+                sn_free(block);
+        }
+        (void)sink;
+    }
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Measures an sn_malloc, touch, sn_free cycle under every sanitize policy
+// against the old behavior of a plain memset on both alloc and free
+
+#include "libsafetynet.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using bench_clock = std::chrono::steady_clock;
+
+static double ns_per_op(bench_clock::time_point start, bench_clock::time_point end, std::size_t ops)
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()) / static_cast<double>(ops);
+}
+
+// Keeps the compiler from eliding the malloc/memset/free of the baseline
+static void escape(void* block)
+{
+    asm volatile("" : : "r"(block) : "memory");
+}
+
+// The caller only writes the start of the block, like most buffers sized for the worst case
+static void touch(void* block, std::size_t size)
+{
+    std::memset(block, 0x5A, size < 4096 ? size : 4096);
+    escape(block);
+}
+
+static double legacy_cycle(std::size_t size, std::size_t ops)
+{
+    const auto start = bench_clock::now();
+    for (std::size_t i = 0; i < ops; i++)
+    {
+        void* block = std::malloc(size);
+        std::memset(block, 0, size);
+        touch(block, size);
+        std::memset(block, 0, size);
+        escape(block);
+        std::free(block);
+    }
+    return ns_per_op(start, bench_clock::now(), ops);
+}
+
+static double sn_cycle(std::size_t size, std::size_t ops)
+{
+    const auto start = bench_clock::now();
+    for (std::size_t i = 0; i < ops; i++)
+    {
+        void* block = sn_malloc(size);
+        touch(block, size);
+        sn_free(block);
+    }
+    return ns_per_op(start, bench_clock::now(), ops);
+}
+
+int main()
+{
+    constexpr std::size_t sizes[] = {4 * 1024, 64 * 1024, 1024 * 1024, 16 * 1024 * 1024};
+    constexpr sn_sanitize_mode_e modes[] = {SN_SANITIZE_OFF, SN_SANITIZE_ON_FREE, SN_SANITIZE_ON_ALLOC, SN_SANITIZE_ALWAYS};
+
+    std::printf("%10s %14s %14s %14s %14s %14s\n", "size", "old_memset", "off", "on_free", "on_alloc", "always");
+    for (const std::size_t size : sizes)
+    {
+        // Same total bytes per size so the big blocks don't take forever
+        const std::size_t ops = (std::size_t)1 << 30 >> __builtin_ctzll(size) >> 2;
+
+        std::printf("%10zu %14.1f", size, legacy_cycle(size, ops));
+        for (const sn_sanitize_mode_e mode : modes)
+        {
+            sn_set_sanitize_policy(mode, 0);
+            std::printf(" %14.1f", sn_cycle(size, ops));
+        }
+        std::printf("\n");
+    }
+    std::printf("(ns per alloc/touch/free cycle)\n");
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Aggregate sn_malloc/sn_free throughput as threads are added
+// Each thread churns its own ring of live blocks so the only shared state is the library's
+// With one global lock the total stays flat (or drops), with the sharded registry it should climb with cores
+
+#include "libsafetynet.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using bench_clock = std::chrono::steady_clock;
+
+static void churn(std::size_t ops, std::size_t ring_size, std::atomic<bool>* go)
+{
+    std::vector<void*> ring(ring_size, nullptr);
+    while (!go->load(std::memory_order_acquire))
+        std::this_thread::yield();
+
+    for (std::size_t i = 0; i < ops; i++)
+    {
+        void*& slot = ring[i % ring_size];
+        if (slot) sn_free(slot);
+        slot = sn_malloc(16 + (i & 0xFF));
+    }
+
+    for (void* block : ring)
+    {
+        if (block) sn_free(block);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t max_threads = 16;
+    if (argc > 1) max_threads = std::strtoull(argv[1], nullptr, 10);
+
+    constexpr std::size_t ops_per_thread = 200'000;
+    constexpr std::size_t ring_size = 256;
+
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    std::printf("%8s %16s %16s\n", "threads", "total_Mops/s", "per_thread");
+
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::atomic<bool> go{false};
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (std::size_t t = 0; t < threads; t++)
+            workers.emplace_back(churn, ops_per_thread, ring_size, &go);
+
+        const auto start = bench_clock::now();
+        go.store(true, std::memory_order_release);
+        for (auto& worker : workers)
+            worker.join();
+        const double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+        // One op is a malloc plus a free
+        const double mops = static_cast<double>(threads * ops_per_thread) / seconds / 1e6;
+        std::printf("%8zu %16.2f %16.2f\n", threads, mops, mops / static_cast<double>(threads));
+    }
+
+    return 0;
+}
@@ -21,7 +21,10 @@
 #define __SN_DEBUG_CALLS__
 #include "libsafetynet.h"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 TEST(SafetynetAllocatorTests, mAllocOfZeroErrorTest)
 {
@@ -77,3 +80,278 @@ TEST(SafetynetAllocatorTests, AllocFreeCycling)
         sn_reset_last_error();
     }
 }
+
+TEST(SafetynetAllocatorTests, ReallocTracksMovedBlock)
+{
+    void* small = sn_malloc(8);
+    ASSERT_NE(small, nullptr);
+
+    // Growing this much forces libc to hand back a different block
+    void* grown = sn_realloc(small, 1 << 20);
+    ASSERT_NE(grown, nullptr);
+    EXPECT_EQ(sn_query_size(grown), static_cast<std::size_t>(1 << 20));
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+
+    if (grown != small)
+    {
+        EXPECT_EQ(sn_query_size(small), 0u);
+        EXPECT_EQ(sn_get_last_error(), SN_ERR_NO_ADDER_FOUND);
+        sn_reset_last_error();
+    }
+
+    sn_free(grown);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+    sn_free(grown);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_NO_ADDER_FOUND);
+    sn_reset_last_error();
+}
+
+TEST(SafetynetAllocatorTests, SmallBlocksComeBackThroughThreadCache)
+{
+    const std::size_t usage_before = sn_query_total_memory_usage();
+
+    void* block = sn_malloc(40);
+    ASSERT_NE(block, nullptr);
+    sn_free(block);
+
+    // Parked, so it is as gone as any freed block
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before);
+    EXPECT_FALSE(sn_is_tracked_block(block));
+    sn_free(block);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_NO_ADDER_FOUND);
+    sn_reset_last_error();
+
+    // Same size class, so the same memory, tracked with the new size
+    void* reused = sn_malloc(33);
+    EXPECT_EQ(reused, block);
+    EXPECT_EQ(sn_query_size(reused), 33u);
+    EXPECT_EQ(sn_query_total_memory_usage() - usage_before, 33u);
+    sn_free(reused);
+
+    sn_do_thread_cache(0);
+    void* uncached = sn_malloc(40);
+    sn_free(uncached);
+    void* from_libc = sn_malloc(40);
+    EXPECT_NE(from_libc, reused); // The parked one stays parked while the cache is off
+    sn_free(from_libc);
+    sn_do_thread_cache(1);
+}
+
+TEST(SafetynetAllocatorTests, AlignedBlocksStayAligned)
+{
+    void* block = sn_aligned_alloc(256, 100);
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block) % 256, 0u);
+    EXPECT_EQ(sn_query_size(block), 100u);
+
+    static_cast<std::uint8_t*>(block)[99] = 0x5A;
+    block = sn_realloc(block, 100000);
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block) % 256, 0u);
+    EXPECT_EQ(static_cast<std::uint8_t*>(block)[99], 0x5A);
+    EXPECT_EQ(sn_query_size(block), 100000u);
+    sn_free(block);
+    EXPECT_FALSE(sn_is_tracked_block(block));
+
+    void* line = sn_malloc_cacheline(8);
+    void* page = sn_malloc_pages(8);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(line) % SN_CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(page) % 4096, 0u);
+    sn_free(line);
+    sn_free(page);
+
+    EXPECT_EQ(sn_aligned_alloc(48, 16), nullptr);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_BAD_ALIGNMENT);
+    sn_reset_last_error();
+}
+
+TEST(SafetynetAllocatorTests, LargeBlocksAreMappedAndRemapped)
+{
+    sn_set_mmap_threshold(1024 * 1024);
+
+    auto* block = static_cast<std::uint8_t*>(sn_malloc(4 * 1024 * 1024));
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block) % 4096, 0u);
+    EXPECT_EQ(block[12345], 0);
+    block[12345] = 0xA5;
+
+    block = static_cast<std::uint8_t*>(sn_realloc(block, 64 * 1024 * 1024));
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(block[12345], 0xA5);
+    EXPECT_EQ(sn_query_size(block), 64u * 1024 * 1024);
+
+    block = static_cast<std::uint8_t*>(sn_realloc(block, 2 * 1024 * 1024));
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(block[12345], 0xA5);
+    EXPECT_EQ(sn_query_size(block), 2u * 1024 * 1024);
+
+    sn_free(block);
+    EXPECT_FALSE(sn_is_tracked_block(block));
+
+    sn_set_mmap_threshold(0);
+}
+
+TEST(SafetynetAllocatorTests, BatchAllocAndFree)
+{
+    constexpr std::size_t count = 1000;
+    std::size_t sizes[count];
+    void* blocks[count];
+    std::size_t total = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        sizes[i] = 8 + (i % 97) * 3;
+        total += sizes[i];
+    }
+
+    const std::size_t before = sn_query_total_memory_usage();
+    ASSERT_TRUE(sn_malloc_batch(count, sizes, blocks));
+    EXPECT_EQ(sn_query_total_memory_usage(), before + total);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        ASSERT_TRUE(sn_is_tracked_block(blocks[i]));
+        EXPECT_EQ(sn_query_size(blocks[i]), sizes[i]);
+        std::memset(blocks[i], 0x3C, sizes[i]);
+    }
+
+    // The bad and repeated pointers are skipped, every real block still goes
+    int untracked = 0;
+    void* frees[count + 2];
+    std::copy(blocks, blocks + count, frees);
+    frees[count] = &untracked;
+    frees[count + 1] = blocks[7];
+    sn_free_batch(frees, count + 2);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_NO_ADDER_FOUND);
+    sn_reset_last_error();
+
+    EXPECT_EQ(sn_query_total_memory_usage(), before);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        EXPECT_FALSE(sn_is_tracked_block(blocks[i]));
+    }
+
+    std::size_t bad_sizes[2] = {16, 0};
+    EXPECT_FALSE(sn_malloc_batch(2, bad_sizes, blocks));
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_BAD_SIZE);
+    sn_reset_last_error();
+
+    // Past the mmap threshold a batch block is mapped like one from sn_malloc
+    sn_set_mmap_threshold(1024 * 1024);
+    std::size_t mixed_sizes[2] = {4 * 1024 * 1024, 64};
+    ASSERT_TRUE(sn_malloc_batch(2, mixed_sizes, blocks));
+    auto* big = static_cast<std::uint8_t*>(blocks[0]);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(big) % 4096, 0u);
+    EXPECT_EQ(big[12345], 0);
+    big[12345] = 0xA5;
+    big = static_cast<std::uint8_t*>(sn_realloc(big, 16 * 1024 * 1024)); // Remapped
+    ASSERT_NE(big, nullptr);
+    EXPECT_EQ(big[12345], 0xA5);
+    blocks[0] = big;
+    EXPECT_EQ(sn_query_size(blocks[1]), 64u);
+    sn_free_batch(blocks, 2);
+    EXPECT_EQ(sn_query_total_memory_usage(), before);
+    sn_set_mmap_threshold(0);
+}
+
+namespace
+{
+    // Hands out memory full of junk and remembers whether blocks came back zeroed
+    struct dirty_backend_t
+    {
+        std::size_t last_size = 0;
+        bool freed_clean = false;
+    };
+
+    void* dirtyMalloc(void* ctx, std::size_t size)
+    {
+        static_cast<dirty_backend_t*>(ctx)->last_size = size;
+        void* ptr = std::malloc(size);
+        if (ptr) std::memset(ptr, 0xAA, size);
+        return ptr;
+    }
+
+    void* dirtyRealloc(void*, void* ptr, std::size_t new_size)
+    {
+        return std::realloc(ptr, new_size);
+    }
+
+    void dirtyFree(void* ctx, void* ptr)
+    {
+        auto* backend = static_cast<dirty_backend_t*>(ctx);
+        const auto* bytes = static_cast<const std::uint8_t*>(ptr);
+        backend->freed_clean = std::all_of(bytes, bytes + backend->last_size, [](std::uint8_t b) { return b == 0; });
+        std::free(ptr);
+    }
+
+    bool allZero(const void* ptr, std::size_t size)
+    {
+        const auto* bytes = static_cast<const std::uint8_t*>(ptr);
+        return std::all_of(bytes, bytes + size, [](std::uint8_t b) { return b == 0; });
+    }
+}
+
+TEST(SafetynetAllocatorTests, SanitizePolicyFollowsRuntimeSetting)
+{
+    static dirty_backend_t backend;
+    const sn_backend_ops_t ops = {dirtyMalloc, nullptr, dirtyRealloc, dirtyFree, nullptr, &backend};
+    ASSERT_TRUE(sn_set_backend_allocator(&ops));
+
+    // Big enough for the streaming clear
+    constexpr std::size_t size = 512 * 1024;
+
+    sn_set_sanitize_policy(SN_SANITIZE_ON_ALLOC, 0);
+    void* block = sn_malloc(size);
+    ASSERT_NE(block, nullptr);
+    EXPECT_TRUE(allZero(block, size));
+    std::memset(block, 0x11, size);
+    sn_free(block);
+    EXPECT_FALSE(backend.freed_clean);
+
+    sn_set_sanitize_policy(SN_SANITIZE_ON_FREE, 0);
+    block = sn_malloc(size);
+    ASSERT_NE(block, nullptr);
+    EXPECT_FALSE(allZero(block, size));
+    sn_free(block);
+    EXPECT_TRUE(backend.freed_clean);
+
+    // Over the size cap nothing is touched
+    sn_set_sanitize_policy(SN_SANITIZE_ALWAYS, size - 1);
+    block = sn_malloc(size);
+    ASSERT_NE(block, nullptr);
+    EXPECT_FALSE(allZero(block, size));
+    sn_free(block);
+    EXPECT_FALSE(backend.freed_clean);
+
+    sn_set_sanitize_policy(SN_SANITIZE_ON_FREE, 0);
+    sn_set_backend_allocator(nullptr);
+}
+
+TEST(SafetynetAllocatorTests, ReallocGrowsInPlaceWithinUsableSize)
+{
+    const std::size_t usage_before = sn_query_total_memory_usage();
+
+    auto* buffer = static_cast<std::uint8_t*>(sn_malloc(100));
+    ASSERT_NE(buffer, nullptr);
+    const std::size_t usable = sn_query_usable_size(buffer);
+    EXPECT_GE(usable, 100u);
+    buffer[99] = 0x42;
+
+    // Append a byte at a time, nothing may move until the slack runs out
+    for (std::size_t size = 101; size <= usable; size++)
+    {
+        ASSERT_EQ(sn_realloc(buffer, size), buffer);
+        EXPECT_EQ(sn_query_size(buffer), size);
+    }
+    EXPECT_EQ(sn_query_usable_size(buffer), usable);
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before + usable);
+
+    buffer = static_cast<std::uint8_t*>(sn_realloc(buffer, usable * 64));
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_EQ(buffer[99], 0x42);
+    EXPECT_GE(sn_query_usable_size(buffer), usable * 64);
+
+    sn_free(buffer);
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before);
+    EXPECT_EQ(sn_query_usable_size(buffer), 0u);
+    sn_reset_last_error();
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#include "libsafetynet.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+
+TEST(SafetynetArenaTests, BumpAllocatesInsideOneBlock)
+{
+    const std::size_t usage_before = sn_query_total_memory_usage();
+
+    sn_arena_t* arena = sn_arena_create(1024);
+    ASSERT_NE(arena, nullptr);
+    const std::size_t arena_usage = sn_query_total_memory_usage() - usage_before;
+    EXPECT_GE(arena_usage, 1024u);
+
+    auto* first = static_cast<std::uint8_t*>(sn_arena_alloc(arena, 3));
+    auto* second = static_cast<std::uint8_t*>(sn_arena_alloc(arena, 100));
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(second) % 16, 0u);
+    EXPECT_GE(second, first + 3);
+
+    // Sub allocations cost nothing extra and are not blocks of their own
+    EXPECT_EQ(sn_query_total_memory_usage() - usage_before, arena_usage);
+    EXPECT_FALSE(sn_is_tracked_block(second));
+    EXPECT_EQ(sn_find_containing_block(second, nullptr), static_cast<void*>(arena));
+
+    EXPECT_EQ(sn_arena_alloc(arena, 2048), nullptr);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_ARENA_FULL);
+    sn_reset_last_error();
+
+    sn_arena_reset(arena);
+    EXPECT_EQ(sn_arena_alloc(arena, 1024), first); // Whole capacity is back
+
+    sn_arena_destroy(arena);
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before);
+
+    // A capacity off the alignment still holds an allocation of that size
+    sn_arena_t* odd = sn_arena_create(10);
+    ASSERT_NE(odd, nullptr);
+    EXPECT_NE(sn_arena_alloc(odd, 10), nullptr);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+    sn_arena_destroy(odd);
+}
+
+TEST(SafetynetArenaTests, RespectsAllocLimit)
+{
+    sn_set_alloc_limit(sn_query_total_memory_usage() + 4096);
+    EXPECT_EQ(sn_arena_create(1 << 20), nullptr);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_ALLOC_LIMIT_HIT);
+    sn_reset_last_error();
+    sn_set_alloc_limit(0);
+}
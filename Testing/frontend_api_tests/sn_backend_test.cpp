@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#include "libsafetynet.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    // Wraps the reference libc backend and counts what is live
+    struct counting_backend_t
+    {
+        long live = 0;
+        long mallocs = 0;
+    };
+
+    void* countingMalloc(void* ctx, std::size_t size)
+    {
+        auto* counts = static_cast<counting_backend_t*>(ctx);
+        counts->live++;
+        counts->mallocs++;
+        const sn_backend_ops_t* libc = sn_get_libc_backend_allocator();
+        return libc->malloc_fn(libc->ctx, size);
+    }
+
+    void* countingRealloc(void* ctx, void* ptr, std::size_t new_size)
+    {
+        (void)ctx;
+        const sn_backend_ops_t* libc = sn_get_libc_backend_allocator();
+        return libc->realloc_fn(libc->ctx, ptr, new_size);
+    }
+
+    void countingFree(void* ctx, void* ptr)
+    {
+        static_cast<counting_backend_t*>(ctx)->live--;
+        const sn_backend_ops_t* libc = sn_get_libc_backend_allocator();
+        libc->free_fn(libc->ctx, ptr);
+    }
+
+    // Node pages stay with their backend until exit, so these have to outlive the test
+    counting_backend_t block_counts;
+    counting_backend_t node_counts;
+}
+
+TEST(SafetynetBackendTests, SwappedBackendsKeepAccountingStraight)
+{
+    const sn_backend_ops_t block_ops = {countingMalloc, nullptr, countingRealloc, countingFree, nullptr, &block_counts};
+    const sn_backend_ops_t node_ops = {countingMalloc, nullptr, countingRealloc, countingFree, nullptr, &node_counts};
+
+    // Bigger than anything the thread cache keeps so every block really comes from the backend
+    constexpr std::size_t block_size = 512;
+    constexpr std::size_t count = 8000;
+
+    void* from_libc = sn_malloc(block_size);
+    ASSERT_NE(from_libc, nullptr);
+    const std::size_t usage_before = sn_query_total_memory_usage();
+
+    ASSERT_TRUE(sn_set_backend_allocator(&block_ops));
+    ASSERT_TRUE(sn_set_node_backend_allocator(&node_ops));
+
+    std::vector<void*> blocks(count);
+    for (auto& block : blocks)
+    {
+        block = sn_malloc(block_size);
+        ASSERT_NE(block, nullptr);
+    }
+    blocks[0] = sn_realloc(blocks[0], block_size * 4);
+    ASSERT_NE(blocks[0], nullptr);
+
+    EXPECT_EQ(block_counts.live, static_cast<long>(count));
+    EXPECT_GT(node_counts.mallocs, 0);
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before + count * block_size + block_size * 3);
+
+    // Goes back to libc, not the backend that is current now
+    sn_free(from_libc);
+    EXPECT_EQ(block_counts.live, static_cast<long>(count));
+
+    EXPECT_TRUE(sn_set_backend_allocator(nullptr));
+    for (void* block : blocks)
+    {
+        sn_free(block);
+    }
+    EXPECT_EQ(block_counts.live, 0);
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before - block_size);
+
+    EXPECT_TRUE(sn_set_node_backend_allocator(nullptr));
+
+    const sn_backend_ops_t incomplete = {countingMalloc, nullptr, nullptr, countingFree, nullptr, &block_counts};
+    EXPECT_FALSE(sn_set_backend_allocator(&incomplete));
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_NULL_PTR);
+    sn_reset_last_error();
+}
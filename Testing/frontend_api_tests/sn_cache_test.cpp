@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#include "libsafetynet.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+static bool is_cached(void* block)
+{
+    const sn_mem_metadata_t* metadata = sn_query_metadata(block);
+    return metadata && metadata->cached;
+}
+
+// Repeat lookups on one thread are answered by that thread's own lookup cache and never reach the shared one,
+// so each of these comes from a thread that has not seen block yet
+static void lookup_elsewhere(void* block, int times)
+{
+    for (int i = 0; i < times; i++)
+        std::thread([block] { sn_query_size(block); }).join();
+}
+
+// Lets blocks other tests left behind cool off, then starts from an empty cache of slots slots
+static void fresh_cache(std::size_t slots)
+{
+    for (int i = 0; i < 9; i++)
+        sn_maintenance_run_once();
+    ASSERT_EQ(sn_set_fast_cache_size(slots), slots);
+}
+
+TEST(SafetynetCacheTests, PinFreezeAndFlush)
+{
+    fresh_cache(SN_CONFIG_FAST_CACHE_SLOTS);
+    void* pinned = sn_malloc(64);
+    void* other = sn_malloc(64);
+
+    EXPECT_TRUE(sn_request_to_fast_cache(pinned));
+    EXPECT_TRUE(is_cached(pinned));
+    EXPECT_TRUE(sn_request_to_fast_cache(pinned)); // Already there is fine
+
+    // Frozen, no new entries but lookups still hit
+    sn_lock_fast_cache();
+    EXPECT_FALSE(sn_request_to_fast_cache(other));
+    EXPECT_FALSE(is_cached(other));
+    EXPECT_TRUE(is_cached(pinned));
+    sn_unlock_fast_cache();
+
+    sn_fast_cache_clear();
+    EXPECT_FALSE(is_cached(pinned));
+
+    // A freed block leaves the cache with it
+    EXPECT_TRUE(sn_request_to_fast_cache(other));
+    sn_free(other);
+    void* reused = sn_malloc(64);
+    EXPECT_FALSE(is_cached(reused));
+
+    sn_free(reused);
+    sn_free(pinned);
+}
+
+TEST(SafetynetCacheTests, SizeRoundsUpToWholeSets)
+{
+    EXPECT_EQ(sn_set_fast_cache_size(5), 8u);
+    EXPECT_EQ(sn_set_fast_cache_size(0), 4u);
+    EXPECT_EQ(sn_set_fast_cache_size(SN_CONFIG_FAST_CACHE_SLOTS), static_cast<std::size_t>(SN_CONFIG_FAST_CACHE_SLOTS));
+}
+
+TEST(SafetynetCacheTests, HotBlocksStayCached)
+{
+    fresh_cache(4); // A single set, everything competes for the same four slots
+
+    void* hot = sn_malloc(64);
+    lookup_elsewhere(hot, 2);
+    sn_maintenance_run_once();
+    ASSERT_TRUE(is_cached(hot));
+
+    std::vector<void*> cold;
+    for (int round = 0; round < 8; round++)
+    {
+        lookup_elsewhere(hot, 1); // A hit, so the clock hand passes it over once
+        for (int i = 0; i < 2; i++)
+        {
+            void* block = sn_malloc(64);
+            lookup_elsewhere(block, 2);
+            cold.push_back(block);
+        }
+        sn_maintenance_run_once();
+    }
+    EXPECT_TRUE(is_cached(hot));
+
+    // Cold blocks were cycled through, only three fit next to the hot one
+    std::size_t cold_cached = 0;
+    for (void* block : cold)
+        cold_cached += is_cached(block);
+    EXPECT_LE(cold_cached, 3u);
+
+    // Pinned slots are never victims, a full set of them refuses further pins
+    sn_fast_cache_clear();
+    for (int i = 0; i < 4; i++)
+        EXPECT_TRUE(sn_request_to_fast_cache(cold[i]));
+    EXPECT_FALSE(sn_request_to_fast_cache(hot));
+    lookup_elsewhere(hot, 2);
+    sn_maintenance_run_once();
+    EXPECT_FALSE(is_cached(hot));
+
+    for (void* block : cold)
+        sn_free(block);
+    sn_free(hot);
+    sn_set_fast_cache_size(SN_CONFIG_FAST_CACHE_SLOTS);
+}
+
+TEST(SafetynetCacheTests, StatsCountEveryLookupPath)
+{
+    fresh_cache(SN_CONFIG_FAST_CACHE_SLOTS);
+    sn_stats_t before{};
+    ASSERT_TRUE(sn_get_stats(&before));
+
+    void* block = sn_malloc(256);
+    sn_query_size(block);                 // Index, and now in this thread's lookup cache
+    sn_query_size(block);                 // Thread cache
+    EXPECT_TRUE(sn_request_to_fast_cache(block));
+    lookup_elsewhere(block, 1);           // Fast cache
+
+    void* twin = sn_malloc(16);
+    sn_set_block_id(twin, 4242);
+    sn_set_block_id(block, 4242);
+    sn_free(twin);                        // Dropping the owner of a shared id looks for the other holder
+    sn_free(block);
+
+    sn_stats_t after{};
+    ASSERT_TRUE(sn_get_stats(&after));
+    EXPECT_GE(after.lookups_index - before.lookups_index, 1u);
+    EXPECT_GE(after.lookups_thread_cache - before.lookups_thread_cache, 1u);
+    EXPECT_GE(after.lookups_cache - before.lookups_cache, 1u);
+    EXPECT_GE(after.cache_hits - before.cache_hits, 1u);
+    EXPECT_EQ(after.cache_pins - before.cache_pins, 1u);
+    EXPECT_GE(after.lookups_scan - before.lookups_scan, 1u);
+    EXPECT_GE(after.lock_acquisitions, before.lock_acquisitions); // Strictly more, unless built without SN_CONFIG_ENABLE_MUTEX
+    EXPECT_LE(after.lock_contended, after.lock_acquisitions);
+    EXPECT_EQ(after.cache_slots, static_cast<std::size_t>(SN_CONFIG_FAST_CACHE_SLOTS));
+    EXPECT_GE(after.peak_bytes, after.registry_bytes);
+    EXPECT_GE(after.peak_blocks, after.registry_blocks);
+
+    EXPECT_FALSE(sn_get_stats(nullptr));
+    sn_reset_last_error();
+}
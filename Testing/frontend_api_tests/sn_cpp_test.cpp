@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Global new/delete replacement has its own binary (Testing/global_new_tests), here it would skew every other test's counts
+#include "safetynet.hpp"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+TEST(SafetynetCppTests, ContainersAreTracked)
+{
+    const std::size_t before = sn_query_total_memory_usage();
+    {
+        std::pmr::vector<int> numbers(safetynet::get_memory_resource());
+        numbers.assign(1000, 7);
+        EXPECT_NE(sn_query_metadata(numbers.data()), nullptr);
+        EXPECT_GE(sn_query_total_memory_usage(), before + 1000 * sizeof(int));
+
+        std::map<int, std::string, std::less<>, safetynet::allocator<std::pair<const int, std::string>>> names;
+        names[1] = "one";
+        names[2] = std::string(100, 'x');
+        EXPECT_EQ(names.size(), 2u);
+
+        static_assert(sizeof(std::vector<int, safetynet::allocator<int>>) == sizeof(std::vector<int>));
+        std::vector<int, safetynet::allocator<int>> grown;
+        for (int i = 0; i < 10000; i++)
+            grown.push_back(i);
+        EXPECT_EQ(grown[9999], 9999);
+    }
+    // Every block came back through the sized frees without a size mismatch
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+    EXPECT_EQ(sn_query_total_memory_usage(), before);
+}
+
+namespace
+{
+    struct alignas(64) wide
+    {
+        std::uint8_t bytes[64];
+    };
+
+    struct base
+    {
+        virtual ~base() = default;
+    };
+
+    struct derived : base
+    {
+        std::uint64_t payload[32] = {};
+    };
+}
+
+TEST(SafetynetCppTests, OwningHandles)
+{
+    const std::size_t before = sn_query_total_memory_usage();
+    {
+        auto aligned = safetynet::make_unique<wide>();
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned.get()) % 64, 0u);
+
+        safetynet::unique_ptr<base> object = safetynet::make_unique<derived>();
+        EXPECT_EQ(sn_query_size(dynamic_cast<derived*>(object.get())), sizeof(derived));
+
+        safetynet::unique_block block = safetynet::make_block(256);
+        ASSERT_NE(block, nullptr);
+        EXPECT_EQ(sn_query_size(block.get()), 256u);
+
+    }
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+    EXPECT_EQ(sn_query_total_memory_usage(), before);
+}
+
+TEST(SafetynetCppTests, SizedFreeChecksTheSize)
+{
+    const size_t before = sn_query_total_memory_usage();
+    void* block = sn_malloc(128);
+    ASSERT_NE(block, nullptr);
+
+    sn_reset_last_error();
+    sn_free_sized(block, 128);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+    EXPECT_EQ(sn_query_size(block), 0u);
+
+    // A mismatch is reported, the block goes all the same
+    block = sn_malloc(128);
+    ASSERT_NE(block, nullptr);
+    sn_free_sized(block, 64);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_BAD_SIZE);
+    EXPECT_EQ(sn_query_size(block), 0u);
+    EXPECT_EQ(sn_query_total_memory_usage(), before);
+    sn_reset_last_error();
+}
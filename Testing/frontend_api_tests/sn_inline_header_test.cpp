@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#include "libsafetynet.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+
+class SafetynetInlineHeaderTests : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        sn_do_inline_headers(1);
+        sn_reset_last_error();
+    }
+
+    void TearDown() override
+    {
+        sn_do_inline_headers(0);
+        sn_reset_last_error();
+    }
+};
+
+TEST_F(SafetynetInlineHeaderTests, MetadataThroughHeader)
+{
+    auto* buff = static_cast<std::uint32_t*>(sn_calloc(8, sizeof(std::uint32_t)));
+    ASSERT_NE(buff, nullptr);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(buff) % alignof(std::max_align_t), 0u);
+
+    EXPECT_EQ(sn_query_size(buff), 8 * sizeof(std::uint32_t));
+    EXPECT_EQ(sn_query_tid(buff), sn_query_tid(buff));
+    EXPECT_TRUE(sn_is_tracked_block(buff));
+
+    sn_set_block_id(buff, 321);
+    EXPECT_EQ(sn_get_block_id(buff), 321);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+
+    buff = static_cast<std::uint32_t*>(sn_realloc(buff, 4096));
+    ASSERT_NE(buff, nullptr);
+    EXPECT_EQ(sn_query_size(buff), 4096u);
+    EXPECT_EQ(sn_get_block_id(buff), 321);
+
+    sn_free(buff);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+    sn_free(buff);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_NO_ADDER_FOUND);
+}
+
+TEST_F(SafetynetInlineHeaderTests, ForeignBlockFallsBackToRegistry)
+{
+    void* foreign = std::malloc(64);
+    ASSERT_NE(foreign, nullptr);
+    ASSERT_EQ(sn_register_size(foreign, 64), foreign);
+
+    EXPECT_EQ(sn_query_size(foreign), 64u);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+
+    sn_free(foreign);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+}
+
+TEST_F(SafetynetInlineHeaderTests, ModeCanBeToggledWithLiveBlocks)
+{
+    void* with_header = sn_malloc(32);
+    sn_do_inline_headers(0);
+    void* without_header = sn_malloc(32);
+    sn_do_inline_headers(1);
+
+    EXPECT_EQ(sn_query_size(with_header), 32u);
+    EXPECT_EQ(sn_query_size(without_header), 32u);
+
+    sn_free(without_header);
+    sn_do_inline_headers(0);
+    sn_free(with_header);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#include "libsafetynet.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+static sn_maintenance_stats_t query_maintenance()
+{
+    sn_maintenance_stats_t stats{};
+    EXPECT_TRUE(sn_query_maintenance_stats(&stats));
+    return stats;
+}
+
+// Waits up to a couple of seconds for the thread to get past passes
+static bool wait_for_passes(std::size_t passes)
+{
+    for (int i = 0; i < 400; i++)
+    {
+        if (query_maintenance().passes > passes) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+TEST(SafetynetMaintenanceTests, RunOnceSamplesUsage)
+{
+    void* block = sn_malloc(4096);
+    ASSERT_NE(block, nullptr);
+
+    const std::size_t passes = query_maintenance().passes;
+    sn_maintenance_run_once();
+
+    const sn_maintenance_stats_t stats = query_maintenance();
+    EXPECT_EQ(stats.passes, passes + 1);
+    EXPECT_GE(stats.sampled_usage, 4096u);
+    EXPECT_GE(stats.peak_sampled_usage, stats.sampled_usage);
+    EXPECT_GE(stats.blocks_scanned, 1u);
+
+    sn_free(block);
+    EXPECT_FALSE(sn_query_maintenance_stats(nullptr));
+}
+
+TEST(SafetynetMaintenanceTests, ThreadStartsPausesAndStops)
+{
+    if (!sn_maintenance_start(1))
+    {
+        // Builds without SN_CONFIG_ENABLE_MUTEX have no threads, sn_maintenance_run_once is all there is
+        EXPECT_EQ(sn_get_last_error(), SN_ERR_SYS_FAIL);
+        EXPECT_FALSE(query_maintenance().running);
+        GTEST_SKIP();
+    }
+    EXPECT_TRUE(query_maintenance().running);
+    EXPECT_TRUE(wait_for_passes(query_maintenance().passes));
+
+    // Starting again only changes the period
+    EXPECT_TRUE(sn_maintenance_start(1));
+
+    sn_maintenance_pause();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Let a pass already under way finish
+    const std::size_t paused_at = query_maintenance().passes;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_TRUE(query_maintenance().paused);
+    EXPECT_EQ(query_maintenance().passes, paused_at);
+
+    sn_maintenance_resume();
+    EXPECT_TRUE(wait_for_passes(paused_at));
+
+    sn_maintenance_stop();
+    const sn_maintenance_stats_t stopped = query_maintenance();
+    EXPECT_FALSE(stopped.running);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(query_maintenance().passes, stopped.passes);
+
+    sn_maintenance_stop(); // Stopping twice is fine
+}
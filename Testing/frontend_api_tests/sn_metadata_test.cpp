@@ -0,0 +1,480 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#include "libsafetynet.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST(SafetynetMetadataTests, BlockIdLookup)
+{
+    void* block = sn_malloc(16);
+    ASSERT_NE(block, nullptr);
+
+    sn_set_block_id(block, 1000);
+    EXPECT_EQ(sn_query_block_id(1000), block);
+
+    // Re-naming a block drops the old name
+    sn_set_block_id(block, 1001);
+    EXPECT_EQ(sn_query_block_id(1001), block);
+    EXPECT_EQ(sn_query_block_id(1000), nullptr);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_NO_ADDER_FOUND);
+    sn_reset_last_error();
+
+    sn_free(block);
+    EXPECT_EQ(sn_query_block_id(1001), nullptr);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_NO_ADDER_FOUND);
+    sn_reset_last_error();
+}
+
+TEST(SafetynetMetadataTests, SharedBlockIdHandsOver)
+{
+    void* first = sn_malloc(16);
+    void* second = sn_malloc(16);
+
+    sn_set_block_id(first, 2000);
+    sn_set_block_id(second, 2000);
+    EXPECT_EQ(sn_query_block_id(2000), first); // The first block to take an id keeps it
+    sn_set_block_id(second, 2000);
+    EXPECT_EQ(sn_query_block_id(2000), first);
+
+    sn_free(first);
+    EXPECT_EQ(sn_query_block_id(2000), second);
+
+    sn_free(second);
+    EXPECT_EQ(sn_query_block_id(2000), nullptr);
+    sn_reset_last_error();
+
+    // An id only one block carries is dropped without walking the registry
+    sn_stats_t before{};
+    ASSERT_TRUE(sn_get_stats(&before));
+    void* only = sn_malloc(16);
+    sn_set_block_id(only, 2001);
+    sn_set_block_id(only, 2002);
+    sn_free(only);
+    sn_stats_t after{};
+    ASSERT_TRUE(sn_get_stats(&after));
+    EXPECT_EQ(after.lookups_scan, before.lookups_scan);
+    EXPECT_EQ(sn_query_block_id(2001), nullptr);
+    EXPECT_EQ(sn_query_block_id(2002), nullptr);
+    sn_reset_last_error();
+}
+
+TEST(SafetynetMetadataTests, ThreadUsageSurvivesCrossThreadFree)
+{
+    void* blocks[4] = {};
+    std::thread worker([&blocks]
+    {
+        for (auto& block : blocks)
+            block = sn_malloc(100);
+        blocks[3] = sn_realloc(blocks[3], 400);
+    });
+    worker.join();
+
+    const sn_tid_t worker_tid = sn_query_tid(blocks[0]);
+    EXPECT_EQ(sn_query_thread_memory_usage(worker_tid), 700u);
+
+    sn_thread_memory_usage_t usage[64] = {};
+    const std::size_t known = sn_query_all_thread_memory_usage(usage, 64);
+    ASSERT_GE(known, 1u);
+    bool found = false;
+    for (std::size_t i = 0; i < std::min<std::size_t>(known, 64); i++)
+    {
+        if (usage[i].tid != worker_tid) continue;
+        found = true;
+        EXPECT_EQ(usage[i].bytes, 700u);
+        EXPECT_EQ(usage[i].blocks, 4u);
+        EXPECT_EQ(usage[i].peak_bytes, 700u);
+    }
+    EXPECT_TRUE(found);
+
+    // Freed here, but still has to come off the worker's counters
+    for (auto* block : blocks)
+        sn_free(block);
+    EXPECT_EQ(sn_query_thread_memory_usage(worker_tid), 0u);
+}
+
+TEST(SafetynetMetadataTests, FindContainingBlock)
+{
+    std::vector<std::uint8_t*> blocks;
+    for (std::size_t i = 1; i <= 64; i++)
+        blocks.push_back(static_cast<std::uint8_t*>(sn_malloc(i * 8)));
+
+    for (std::size_t i = 0; i < blocks.size(); i++)
+    {
+        const std::size_t size = (i + 1) * 8;
+        std::size_t offset = 0;
+        EXPECT_EQ(sn_find_containing_block(blocks[i], &offset), blocks[i]);
+        EXPECT_EQ(offset, 0u);
+        EXPECT_EQ(sn_find_containing_block(blocks[i] + size - 1, &offset), blocks[i]);
+        EXPECT_EQ(offset, size - 1);
+    }
+
+    std::uint8_t* moved = static_cast<std::uint8_t*>(sn_realloc(blocks[0], 1 << 20));
+    ASSERT_NE(moved, nullptr);
+    blocks[0] = moved;
+    std::size_t offset = 0;
+    EXPECT_EQ(sn_find_containing_block(moved + 4096, &offset), moved);
+    EXPECT_EQ(offset, 4096u);
+
+    std::uint8_t* last = blocks.back();
+    for (auto* block : blocks)
+        sn_free(block);
+
+    EXPECT_EQ(sn_find_containing_block(last, nullptr), nullptr);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_NO_ADDER_FOUND);
+    sn_reset_last_error();
+}
+
+TEST(SafetynetMetadataTests, GlobalQueriesSpanEveryShard)
+{
+    const std::size_t usage_before = sn_query_total_memory_usage();
+
+    std::vector<void*> blocks;
+    std::size_t expected_bytes = 0;
+    for (std::size_t i = 1; i <= 256; i++)
+    {
+        blocks.push_back(sn_malloc(i));
+        expected_bytes += i;
+    }
+    EXPECT_EQ(sn_query_total_memory_usage() - usage_before, expected_bytes);
+
+    // A realloc that moves usually lands in another shard
+    blocks[0] = sn_realloc(blocks[0], 1 << 20);
+    expected_bytes += (1 << 20) - 1;
+    EXPECT_EQ(sn_query_total_memory_usage() - usage_before, expected_bytes);
+
+    std::vector<const void*> seen;
+    sn_mem_metadata_for_each([](sn_mem_metadata_t* ctx, size_t, void* arg) -> sn_mem_metadata_t*
+    {
+        static_cast<std::vector<const void*>*>(arg)->push_back(ctx->data);
+        return nullptr;
+    }, &seen);
+    for (void* block : blocks)
+        EXPECT_NE(std::find(seen.begin(), seen.end(), block), seen.end());
+
+    // Stopping early hands back the block the worker picked
+    void* wanted = blocks[128];
+    const sn_mem_metadata_t* found = sn_mem_metadata_for_each([](sn_mem_metadata_t* ctx, size_t, void* arg) -> sn_mem_metadata_t*
+    {
+        return ctx->data == arg ? ctx : nullptr;
+    }, wanted);
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->data, wanted);
+
+    for (void* block : blocks)
+        sn_free(block);
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before);
+}
+
+TEST(SafetynetMetadataTests, AllocLimitHoldsAcrossThreads)
+{
+    constexpr std::size_t block_size = 1024;
+    const std::size_t usage_before = sn_query_total_memory_usage();
+    const std::size_t limit = usage_before + 1024 * 1024;
+    sn_set_alloc_limit(limit);
+
+    // Every thread allocates until it is refused, the budgets they grab must never add up past the limit
+    std::vector<std::vector<void*>> per_thread(4);
+    std::vector<std::thread> workers;
+    for (auto& blocks : per_thread)
+    {
+        workers.emplace_back([&blocks]
+        {
+            while (void* block = sn_malloc(block_size))
+                blocks.push_back(block);
+            sn_reset_last_error();
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    const std::size_t usage = sn_query_total_memory_usage();
+    EXPECT_LT(usage, limit);
+    // Refused threads pull back idle budget, so only a block or so per thread can be left unused
+    EXPECT_GT(usage + per_thread.size() * block_size * 2, limit);
+
+    // Freed budget is usable again from another thread
+    for (auto& blocks : per_thread)
+    {
+        for (void* block : blocks)
+            sn_free(block);
+    }
+    void* big = sn_malloc(limit - usage_before - block_size);
+    EXPECT_NE(big, nullptr);
+    sn_free(big);
+
+    sn_set_alloc_limit(0);
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before);
+}
+
+TEST(SafetynetMetadataTests, TagsRollUpAndEnforceLimits)
+{
+    sn_tag_t* parent = sn_tag_create("tag_test_parent", nullptr);
+    sn_tag_t* child = sn_tag_create("tag_test_child", parent);
+    ASSERT_NE(parent, nullptr);
+    ASSERT_NE(child, nullptr);
+    EXPECT_EQ(sn_tag_create("tag_test_child", parent), child);
+
+    sn_tag_usage_t usage{};
+    ASSERT_TRUE(sn_query_tag_usage(parent, &usage));
+    const std::size_t parent_before = usage.bytes;
+
+    ASSERT_TRUE(sn_tag_push(parent));
+    ASSERT_TRUE(sn_tag_push(child));
+    EXPECT_EQ(sn_tag_current(), child);
+    void* a = sn_malloc(1000);
+    void* b = sn_realloc(sn_malloc(100), 500);
+    sn_tag_pop();
+    void* c = sn_malloc(200);
+    sn_tag_pop();
+    EXPECT_EQ(sn_tag_current(), nullptr);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    ASSERT_NE(c, nullptr);
+
+    ASSERT_TRUE(sn_query_tag_usage(child, &usage));
+    EXPECT_EQ(usage.bytes, 1500u);
+    EXPECT_EQ(usage.blocks, 2u);
+    ASSERT_TRUE(sn_query_tag_usage(parent, &usage));
+    EXPECT_EQ(usage.bytes, parent_before + 1700);
+
+    // The parent's cap covers its children too
+    sn_tag_set_limit(parent, parent_before + 2000);
+    ASSERT_TRUE(sn_tag_push(child));
+    EXPECT_EQ(sn_malloc(400), nullptr);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_ALLOC_LIMIT_HIT);
+    sn_reset_last_error();
+    void* d = sn_malloc(200);
+    EXPECT_NE(d, nullptr);
+    sn_tag_pop();
+    sn_tag_set_limit(parent, 0);
+
+    // Frees from other threads still come off the tag the block was allocated under
+    std::thread([&] { sn_free(a); sn_free(b); sn_free(d); }).join();
+    sn_free(c);
+
+    ASSERT_TRUE(sn_query_tag_usage(child, &usage));
+    EXPECT_EQ(usage.bytes, 0u);
+    EXPECT_EQ(usage.blocks, 0u);
+    EXPECT_GE(usage.peak_bytes, 1500u);
+    ASSERT_TRUE(sn_query_tag_usage(parent, &usage));
+    EXPECT_EQ(usage.bytes, parent_before);
+
+    std::vector<sn_tag_usage_t> all(sn_query_all_tag_usage(nullptr, 0));
+    EXPECT_EQ(sn_query_all_tag_usage(all.data(), all.size()), all.size());
+    EXPECT_TRUE(std::any_of(all.begin(), all.end(), [&](const sn_tag_usage_t& u) { return u.tag == child && u.parent == parent; }));
+}
+
+TEST(SafetynetMetadataTests, LookupCacheSeesFreesFromOtherThreads)
+{
+    void* block = sn_malloc(96);
+    ASSERT_NE(block, nullptr);
+
+    // Fills this thread's lookup cache, repeats are served from it
+    for (int i = 0; i < 4; i++)
+        EXPECT_EQ(sn_query_size(block), 96u);
+
+    std::thread([block] { sn_free(block); }).join();
+    EXPECT_FALSE(sn_is_tracked_block(block));
+    EXPECT_EQ(sn_query_size(block), 0u);
+    sn_reset_last_error();
+
+    // Resized by another thread, whether it moved or not the cached slot must not hand out the old size
+    void* before = sn_malloc(96);
+    EXPECT_EQ(sn_query_size(before), 96u);
+    void* after = nullptr;
+    std::thread([before, &after] { after = sn_realloc(before, 4096); }).join();
+    ASSERT_NE(after, nullptr);
+    if (after == before)
+    {
+        EXPECT_EQ(sn_query_size(before), 4096u);
+    }
+    else
+    {
+        EXPECT_FALSE(sn_is_tracked_block(before));
+        sn_reset_last_error();
+    }
+    EXPECT_EQ(sn_query_size(after), 4096u);
+    sn_free(after);
+}
+
+TEST(SafetynetMetadataTests, QueriesRunAlongsideAllocation)
+{
+    // More blocks than a thread's lookup cache holds, so readers keep going to the registry
+    constexpr std::size_t block_count = 64;
+    std::vector<void*> shared(block_count);
+    std::vector<uint64_t> checksums(block_count);
+    for (std::size_t i = 0; i < block_count; i++)
+    {
+        shared[i] = sn_calloc(1, 32 + i);
+        ASSERT_NE(shared[i], nullptr);
+        static_cast<unsigned char*>(shared[i])[0] = static_cast<unsigned char>(i);
+        checksums[i] = sn_calculate_checksum(shared[i]);
+    }
+    const sn_tid_t owner = sn_query_tid(shared[0]);
+
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> mismatches(4, 0);
+    for (std::size_t r = 0; r < mismatches.size(); r++)
+    {
+        threads.emplace_back([&, r]
+        {
+            for (int pass = 0; pass < 200; pass++)
+            {
+                for (std::size_t i = 0; i < block_count; i++)
+                {
+                    mismatches[r] += sn_query_size(shared[i]) != 32 + i;
+                    mismatches[r] += !sn_is_tracked_block(shared[i]);
+                    mismatches[r] += sn_query_tid(shared[i]) != owner;
+                    mismatches[r] += sn_calculate_checksum(shared[i]) != checksums[i];
+                }
+            }
+        });
+    }
+    // Writers change the same shards underneath them
+    threads.emplace_back([]
+    {
+        for (int i = 0; i < 5000; i++)
+            sn_free(sn_malloc(16 + (i & 0xFF)));
+    });
+    for (auto& thread : threads)
+        thread.join();
+
+    for (std::size_t count : mismatches)
+        EXPECT_EQ(count, 0u);
+
+    // A walk may query blocks from its worker while others allocate and free
+    std::size_t seen = 0;
+    sn_mem_metadata_for_each([](sn_mem_metadata_t* ctx, size_t, void* arg) -> sn_mem_metadata_t*
+    {
+        *static_cast<std::size_t*>(arg) += sn_query_size(const_cast<void*>(ctx->data)) == ctx->size;
+        return nullptr;
+    }, &seen);
+    EXPECT_GE(seen, block_count);
+
+    for (void* block : shared)
+        sn_free(block);
+}
+
+TEST(SafetynetMetadataTests, WriterProgressesUnderSteadyQueries)
+{
+    constexpr std::size_t block_count = 64;
+    constexpr int writes = 2000;
+    std::vector<void*> shared(block_count);
+    for (std::size_t i = 0; i < block_count; i++)
+        shared[i] = sn_malloc(32 + i);
+
+    // Readers never pause, a lock that let new readers past a waiting writer would keep it out until the deadline
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    std::atomic<bool> writer_done{false};
+    std::atomic<std::size_t> queries{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++)
+    {
+        readers.emplace_back([&]
+        {
+            while (!writer_done.load() && std::chrono::steady_clock::now() < deadline)
+            {
+                for (void* block : shared)
+                    sn_query_size(block);
+                queries += block_count;
+            }
+        });
+    }
+
+    std::thread writer([&]
+    {
+        while (queries.load() == 0)
+            std::this_thread::yield(); // Start once the readers are in
+        for (int i = 0; i < writes; i++)
+            sn_free(sn_malloc(16 + (i & 0xFF)));
+        writer_done = true;
+    });
+    writer.join();
+    for (auto& reader : readers)
+        reader.join();
+
+    EXPECT_TRUE(writer_done.load());
+    EXPECT_LT(std::chrono::steady_clock::now(), deadline);
+    for (void* block : shared)
+        sn_free(block);
+}
+
+TEST(SafetynetMetadataTests, ForEachWorkerMayCallBackIn)
+{
+    constexpr std::size_t block_count = 64;
+    static constexpr std::size_t marker_size = 4321; // Nothing else in this binary allocates exactly this
+    const std::size_t usage_before = sn_query_total_memory_usage();
+
+    struct walk_t
+    {
+        std::vector<void*> kept;
+        std::size_t visits = 0;
+    } walk;
+    for (std::size_t i = 0; i < block_count; i++)
+        sn_malloc(marker_size);
+
+    // Free half of the blocks, move the rest to a new size and name them, all from inside the walk
+    sn_mem_metadata_for_each([](sn_mem_metadata_t* ctx, size_t, void* arg) -> sn_mem_metadata_t*
+    {
+        if (ctx->size != marker_size) return nullptr;
+        auto* walk = static_cast<walk_t*>(arg);
+        void* block = const_cast<void*>(ctx->data);
+        EXPECT_EQ(sn_query_size(block), marker_size);
+        if (walk->visits++ % 2)
+        {
+            sn_free(block);
+            EXPECT_EQ(ctx->size, marker_size); // A copy, the free leaves it alone
+            EXPECT_EQ(ctx->data, block);
+            return nullptr;
+        }
+        block = sn_realloc(block, 2 * marker_size);
+        EXPECT_NE(block, nullptr);
+        sn_set_block_id(block, 4321);
+        walk->kept.push_back(block);
+        return nullptr;
+    }, &walk);
+
+    // Blocks moved by the walk are not walked again
+    EXPECT_EQ(walk.visits, block_count);
+    ASSERT_EQ(walk.kept.size(), block_count / 2);
+    EXPECT_EQ(sn_query_total_memory_usage() - usage_before, block_count / 2 * 2 * marker_size);
+    for (void* block : walk.kept)
+    {
+        EXPECT_EQ(sn_query_size(block), 2 * marker_size);
+        sn_free(block);
+    }
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before);
+
+    // Stopping the walk hands back the live metadata, not the worker's copy
+    void* target = sn_malloc(marker_size);
+    const sn_mem_metadata_t* found = sn_mem_metadata_for_each([](sn_mem_metadata_t* ctx, size_t, void*) -> sn_mem_metadata_t*
+    {
+        return ctx->size == marker_size ? ctx : nullptr;
+    }, nullptr);
+    EXPECT_EQ(found, sn_query_metadata(target));
+    sn_free(target);
+    sn_reset_last_error();
+}
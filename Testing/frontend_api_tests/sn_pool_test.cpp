@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#include "libsafetynet.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(SafetynetPoolTests, ObjectsComeFromTrackedChunks)
+{
+    const std::size_t usage_before = sn_query_total_memory_usage();
+
+    sn_pool_t* pool = sn_pool_create(40, 8);
+    ASSERT_NE(pool, nullptr);
+
+    sn_pool_usage_t usage{};
+    ASSERT_TRUE(sn_query_pool_usage(pool, &usage));
+    EXPECT_EQ(usage.object_size, 48u);
+    EXPECT_EQ(usage.chunks, 0u);
+
+    std::vector<void*> objects;
+    for (int i = 0; i < 20; i++)
+    {
+        void* object = sn_pool_alloc(pool);
+        ASSERT_NE(object, nullptr);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(object) % 16, 0u);
+        EXPECT_FALSE(sn_is_tracked_block(object));
+        objects.push_back(object);
+    }
+    EXPECT_EQ(std::set<void*>(objects.begin(), objects.end()).size(), objects.size());
+
+    ASSERT_TRUE(sn_query_pool_usage(pool, &usage));
+    EXPECT_EQ(usage.chunks, 3u);
+    EXPECT_EQ(usage.capacity, 24u);
+    EXPECT_EQ(usage.live, 20u);
+    // The chunks are what the pool counts for, objects cost nothing on their own
+    EXPECT_GT(sn_query_total_memory_usage() - usage_before, usage.bytes);
+    EXPECT_NE(sn_find_containing_block(objects[0], nullptr), nullptr);
+
+    // A freed object is the next one handed out
+    sn_pool_free(pool, objects[5]);
+    EXPECT_EQ(sn_pool_alloc(pool), objects[5]);
+
+    for (void* object : objects)
+        sn_pool_free(pool, object);
+    ASSERT_TRUE(sn_query_pool_usage(pool, &usage));
+    EXPECT_EQ(usage.live, 0u);
+    EXPECT_EQ(usage.chunks, 3u);
+
+    sn_pool_destroy(pool);
+    EXPECT_EQ(sn_query_total_memory_usage(), usage_before);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+}
+
+TEST(SafetynetPoolTests, SharedAcrossThreadsAndLimited)
+{
+    sn_pool_t* pool = sn_pool_create(64, 128);
+    ASSERT_NE(pool, nullptr);
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; t++)
+    {
+        workers.emplace_back([pool]
+        {
+            std::vector<void*> held;
+            for (int i = 0; i < 2000; i++)
+            {
+                held.push_back(sn_pool_alloc(pool));
+                if (i % 3 == 0)
+                {
+                    sn_pool_free(pool, held.back());
+                    held.pop_back();
+                }
+            }
+            for (void* object : held)
+                sn_pool_free(pool, object);
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+
+    sn_pool_usage_t usage{};
+    ASSERT_TRUE(sn_query_pool_usage(pool, &usage));
+    EXPECT_EQ(usage.live, 0u);
+
+    // Growing goes through sn_malloc so the alloc limit covers it
+    sn_set_alloc_limit(sn_query_total_memory_usage() + 1024);
+    for (std::size_t i = 0; i < usage.capacity; i++)
+        ASSERT_NE(sn_pool_alloc(pool), nullptr);
+    EXPECT_EQ(sn_pool_alloc(pool), nullptr);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_ALLOC_LIMIT_HIT);
+    sn_reset_last_error();
+    sn_set_alloc_limit(0);
+
+    sn_pool_destroy(pool);
+}
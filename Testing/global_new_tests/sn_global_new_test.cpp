@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#define SN_CPP_REPLACE_GLOBAL_NEW
+#include "safetynet.hpp"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct alignas(64) wide
+    {
+        std::uint8_t bytes[64];
+    };
+
+    struct base
+    {
+        virtual ~base() = default;
+    };
+
+    struct derived : base
+    {
+        std::uint64_t payload[32] = {};
+    };
+}
+
+#ifdef SN_TEST_LATE_FREE
+#include <unistd.h>
+
+extern "C" void (*sn_late_free_hook)(void);
+
+namespace
+{
+    derived* late_object = nullptr;
+
+    // Runs from sn_late_free's destructor, after the library's
+    void free_late_object()
+    {
+        const bool intact = late_object->payload[31] == 0x5AFE;
+        delete late_object;
+        if (!intact || sn_get_last_error() != SN_ERR_OK)
+            _exit(3); // Past gtest's reporting, the exit code is all that is left
+    }
+}
+
+TEST(SafetynetGlobalNewTests, ObjectsOutliveLibraryShutdown)
+{
+    late_object = new derived();
+    late_object->payload[31] = 0x5AFE;
+    sn_late_free_hook = &free_late_object;
+}
+#endif
+
+TEST(SafetynetGlobalNewTests, NewAndDeleteAreTracked)
+{
+    const std::size_t before = sn_query_total_memory_usage();
+    {
+        auto* plain = new derived();
+        EXPECT_EQ(sn_query_size(plain), sizeof(derived));
+        EXPECT_EQ(sn_query_total_memory_usage(), before + sizeof(derived));
+        // The deleting destructor passes the dynamic size, so the sized free still matches
+        base* through_base = plain;
+        delete through_base;
+
+        auto* over_aligned = new wide[3];
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(over_aligned) % 64, 0u);
+        EXPECT_EQ(sn_query_size(over_aligned), sizeof(wide) * 3);
+        delete[] over_aligned;
+
+        auto* nothing = new (std::nothrow) char[0];
+        EXPECT_NE(nothing, nullptr);
+        delete[] nothing;
+
+        std::vector<std::string> strings(100, std::string(200, 'x'));
+        auto shared = std::make_shared<derived>();
+        EXPECT_GT(sn_query_total_memory_usage(), before + 100 * 200);
+    }
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_OK);
+    EXPECT_EQ(sn_query_total_memory_usage(), before);
+}
+
+TEST(SafetynetGlobalNewTests, MismatchedSizedDeleteStillFrees)
+{
+    const std::size_t before = sn_query_total_memory_usage();
+    void* block = ::operator new(256);
+    sn_reset_last_error();
+    ::operator delete(block, 128);
+    EXPECT_EQ(sn_get_last_error(), SN_ERR_BAD_SIZE);
+    EXPECT_EQ(sn_query_total_memory_usage(), before);
+    sn_reset_last_error();
+}
+
+TEST(SafetynetGlobalNewTests, FailureThrowsBadAlloc)
+{
+    sn_set_alloc_limit(sn_query_total_memory_usage() + 4096);
+    EXPECT_THROW((void)new char[1024 * 1024], std::bad_alloc);
+    EXPECT_EQ(new (std::nothrow) char[1024 * 1024], nullptr);
+    sn_set_alloc_limit(0);
+    sn_reset_last_error();
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Stands in for a shared object whose destructors run after libsafetynet's,
+// it links to nothing of the library so the loader finalizes it later
+#include <stddef.h>
+
+void (*sn_late_free_hook)(void) = NULL;
+
+__attribute__((destructor))
+static void sn_late_free_run(void)
+{
+    if (sn_late_free_hook)
+        sn_late_free_hook();
+}
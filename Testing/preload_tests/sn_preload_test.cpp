@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Expects libsafetynet_preload.so in LD_PRELOAD (ctest sets it), nothing here calls safetynet directly
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <dlfcn.h>
+#include <malloc.h>
+#include <unistd.h>
+
+extern "C" void* __libc_malloc(std::size_t size);
+
+using total_usage_f = std::size_t (*)();
+
+static total_usage_f total_usage()
+{
+    return reinterpret_cast<total_usage_f>(dlsym(RTLD_DEFAULT, "sn_query_total_memory_usage"));
+}
+
+// Keeps the compiler from pairing up and dropping a malloc and free it can see
+static void* opaque(void* ptr)
+{
+    asm volatile("" : "+r"(ptr) : : "memory");
+    return ptr;
+}
+
+TEST(SafetynetPreloadTests, MallocFamilyIsTracked)
+{
+    const total_usage_f usage = total_usage();
+    ASSERT_NE(usage, nullptr) << "not running with libsafetynet_preload.so preloaded";
+
+    const std::size_t before = usage();
+    void* block = opaque(std::malloc(1000));
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(usage(), before + 1000);
+
+    std::memset(block, 0x5A, 1000);
+    block = opaque(std::realloc(block, 5000));
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(static_cast<unsigned char*>(block)[999], 0x5A);
+    EXPECT_EQ(usage(), before + 5000);
+    std::free(block);
+    EXPECT_EQ(usage(), before);
+
+    auto* zeroed = static_cast<unsigned char*>(opaque(std::calloc(100, 10)));
+    ASSERT_NE(zeroed, nullptr);
+    for (std::size_t i = 0; i < 1000; i++)
+        ASSERT_EQ(zeroed[i], 0);
+    EXPECT_EQ(usage(), before + 1000);
+    std::free(zeroed);
+
+    void* aligned = nullptr;
+    ASSERT_EQ(posix_memalign(&aligned, 4096, 300), 0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 4096, 0u);
+    EXPECT_EQ(usage(), before + 300);
+    std::free(aligned);
+    EXPECT_EQ(posix_memalign(&aligned, 3, 300), EINVAL);
+
+    void* aligned_blocks[] = {
+        opaque(std::aligned_alloc(64, 128)),
+        opaque(memalign(256, 100)),
+        opaque(valloc(10)),
+        opaque(pvalloc(10))
+    };
+    const std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned_blocks[0]) % 64, 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned_blocks[1]) % 256, 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned_blocks[2]) % page, 0u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(aligned_blocks[3]) % page, 0u);
+    EXPECT_EQ(usage(), before + 128 + 100 + 10 + page);
+    for (void* block : aligned_blocks)
+        std::free(block);
+    EXPECT_EQ(memalign(3, 10), nullptr);
+    EXPECT_EQ(errno, EINVAL);
+
+    EXPECT_EQ(usage(), before);
+}
+
+TEST(SafetynetPreloadTests, EdgeCasesMatchLibc)
+{
+    const total_usage_f usage = total_usage();
+    ASSERT_NE(usage, nullptr);
+    const std::size_t before = usage();
+
+    void* empty = opaque(std::malloc(0));
+    EXPECT_NE(empty, nullptr);
+    std::free(empty);
+
+    void* grown = opaque(std::realloc(nullptr, 64));
+    ASSERT_NE(grown, nullptr);
+    EXPECT_EQ(std::realloc(grown, 0), nullptr);
+    std::free(nullptr);
+
+    // Memory libc handed out on its own still has to realloc and free cleanly
+    void* foreign = opaque(__libc_malloc(128));
+    ASSERT_NE(foreign, nullptr);
+    EXPECT_EQ(usage(), before);
+    foreign = opaque(std::realloc(foreign, 256));
+    ASSERT_NE(foreign, nullptr);
+    EXPECT_EQ(usage(), before);
+    std::free(foreign);
+
+    // Allocations libc makes on its own behalf come through here too
+    char* copy = strdup("safetynet");
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(usage(), before + sizeof("safetynet"));
+    std::free(copy);
+
+    EXPECT_EQ(usage(), before);
+}
+
+TEST(SafetynetPreloadTests, CrossThreadFree)
+{
+    const total_usage_f usage = total_usage();
+    ASSERT_NE(usage, nullptr);
+
+    void* block = nullptr;
+    std::thread([&block] { block = opaque(std::malloc(2048)); }).join();
+    ASSERT_NE(block, nullptr);
+
+    const std::size_t before = usage();
+    std::free(block);
+    EXPECT_EQ(usage(), before - 2048);
+}
+
+TEST(SafetynetPreloadTests, DoubleFreeAbortsLikeLibc)
+{
+    // The second free must reach glibc's checks, not hand the chunk out to two owners
+    EXPECT_DEATH(
+    {
+        void* volatile block = opaque(std::malloc(48)); // volatile, or the compiler rejects the second free outright
+        std::free(block);
+        std::free(block);
+        void* first = opaque(std::malloc(48));
+        void* second = opaque(std::malloc(48));
+        if (first != second) std::abort();
+    }, "double free");
+}
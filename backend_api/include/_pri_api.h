@@ -39,16 +39,81 @@
 #ifndef _PRI_API_H
 #define _PRI_API_H
 #include "linked_list_c.h"
+#include "registry_c.h"
 #include "platform_independent/plat_threading.h"
 #include "allocation_manager/alloc_manager_c.h"
+#include "id_table_c.h"
+#include "thread_usage_c.h"
+#include "tag_usage_c.h"
+#include "thread_cache_c.h"
+#include "stats_c.h"
 
 SN_PUB_API_OPEN
 void sn_set_last_error(const sn_error_codes_e err);
 
-extern linked_list_c mem_list;
+/*
+ * Drops entry from the block id table
+ * If another live block shares the id the slot is handed over to it
+ */
+void sn_pri_release_block_id(linked_list_entry_c entry);
+
+/*
+ * Alloc limit accounting for the calling thread (see memman_reserve) and for tag's budget (see tag_usage_tryCharge)
+ * Allocators reserve before they allocate and release if the allocation then fails,
+ * everything leaving the registry or shrinking releases on its own
+ * tag is the block's tag, sn_pri_current_tag() for a new block
+ */
+SN_BOOL sn_pri_limit_reserve(size_t size, struct tag_usage_node_s* tag);
+void sn_pri_limit_release(size_t size, struct tag_usage_node_s* tag);
+void sn_pri_limit_charge(size_t size, struct tag_usage_node_s* tag);
+
+// Innermost tag pushed on the calling thread, NULL if none
+struct tag_usage_node_s* sn_pri_current_tag();
+
+/*
+ * The only ways a block should enter, leave or change size in the registry
+ * (keeps the running per thread totals honest)
+ */
+linked_list_entry_c sn_pri_registry_insert(void* data, size_t size);
+void sn_pri_registry_remove(linked_list_entry_c entry);
+void sn_pri_registry_resize(linked_list_entry_c entry, void* new_data, size_t new_size);
+
+// The batch forms, out/entries hold count entries in the same order as data
+void sn_pri_registry_insertBatch(void* const* data, const size_t* sizes, size_t count, linked_list_entry_c* out);
+void sn_pri_registry_removeBatch(linked_list_entry_c* entries, size_t count);
+
+// sn_free past the lookup, ptr is the key entry was found under
+void sn_pri_free_entry(linked_list_entry_c entry, void* const ptr);
+
+/*
+ * Park a freed size classed block in the calling thread's cache instead of giving it back to libc
+ * Returns false (and does nothing) if the bin is full, the caller then frees it as usual
+ */
+SN_BOOL sn_pri_registry_park(linked_list_entry_c entry);
+
+// A parked block of size's class back in the registry as a new size byte block owned by the calling thread, NULL if none
+linked_list_entry_c sn_pri_registry_unpark(size_t size);
+
+/*
+ * Other shared objects' constructors can allocate before ours ran (C++ statics once global new is replaced)
+ * and their destructors can allocate and free after ours, so allocators call this when mem_registry is NULL
+ * Returns SN_FALSE once the library has shut down, single block allocators then hand out untracked memory the OS takes back
+ */
+SN_BOOL sn_pri_lazy_init();
+
+// Set up and tear down the maintenance service's state (shutdown also stops its thread), see sn_maintenance_start
+SN_BOOL sn_pri_maintenance_init();
+void sn_pri_maintenance_shutdown();
+
+extern registry_c mem_registry;
 extern plat_mutex_c alloc_mutex;
 extern alloc_manager_m memory_manager;
+extern id_table_c block_id_table;
+extern thread_usage_c thread_usage;
+extern tag_usage_c tag_usage;
+extern thread_cache_c thread_cache;
 extern SN_FLAG doFree;
+extern SN_FLAG doTeardown;
 
 /*
  * This thing is horrid, but we keep it around because it is simple
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * Intrusive AVL tree of list entries ordered by their data address
+ * The links live inside linked_list_entry_t so inserting never allocates
+ * Not thread safe, the owning list guards it with its own mutex
+ */
+
+#ifndef ADDR_TREE_C_H
+#define ADDR_TREE_C_H
+#include <stddef.h>
+
+struct linked_list_entry_s;
+
+typedef struct addr_tree_s
+{
+    struct linked_list_entry_s* root;
+    size_t count;
+} addr_tree_t;
+
+void addr_tree_insert(addr_tree_t* self, struct linked_list_entry_s* entry);
+void addr_tree_remove(addr_tree_t* self, struct linked_list_entry_s* entry);
+
+// The entry with the highest data address that is <= addr
+struct linked_list_entry_s* addr_tree_floor(const addr_tree_t* self, const void* addr);
+
+#endif //ADDR_TREE_C_H
@@ -45,49 +45,115 @@
 #define ALLOC_MANAGER_C_H
 #include "libsafetynet.h"
 #include "linked_list_c.h"
+#include "registry_c.h"
+#include "thread_usage_c.h"
 
 
-#define MEMMAN_MAX_CACHE_SLOTS 5
+#ifndef SN_CONFIG_FAST_CACHE_SLOTS
+#   define SN_CONFIG_FAST_CACHE_SLOTS 64
+#endif
+
+// The fast cache is split into sets of MEMMAN_CACHE_WAYS slots, a block can only live in the set its address hashes to
+#define MEMMAN_CACHE_WAYS 4
+// Registry lookups a block needs between two memman_work passes to be promoted into the fast cache
+#define MEMMAN_CACHE_PROMOTE_WEIGHT 2
+
+// Each thread keeps a direct mapped lookup cache of 1 << MEMMAN_L1_BITS slots in front of the shared one
+#define MEMMAN_L1_BITS 4
+// Generation stamps are handed to threads this many at a time
+#define MEMMAN_GENERATION_BATCH ((uint64_t)65536)
 
 #define MEMMAN_CACHE_MISS NULL
 #define MEMMAN_NO_ALLOC_LIMIT 0
 
+// How much limit budget a thread grabs at once, a thread never sits on more than twice this
+#define MEMMAN_BUDGET_CHUNK ((size_t)64 * 1024)
+
 typedef struct cache_pair_s
 {
     void* key;
     linked_list_entry_c value;
+    SN_FLAG referenced;   // Hit since the clock hand last passed, gets one more round before eviction
+    SN_FLAG pinned;       // Put there with sn_request_to_fast_cache, only a clear or a free takes it out
 } cache_pair_t;
 
+typedef struct cache_set_s
+{
+    cache_pair_t slots[MEMMAN_CACHE_WAYS];
+    uint8_t hand;         // CLOCK hand, the next slot considered for eviction
+} cache_set_t;
+
 typedef struct alloc_manager_s
 {
-    cache_pair_t cache_list[MEMMAN_MAX_CACHE_SLOTS];
-    uint8_t available_cache_slots;
+    cache_set_t* cache_sets;
+    size_t cache_set_count; // Power of two
+    uint8_t cache_set_shift; // 64 - log2(cache_set_count), sets are picked by the top bits of a Fibonacci hash
+    size_t cache_used;      // Occupied slots, read without the lock to skip an empty cache
     SN_BOOL cache_lock;
     SN_BOOL use_cache;
+    SN_BOOL use_inline_headers;
+    SN_BOOL use_thread_cache;
+    SN_BOOL use_huge_pages;
+    size_t mmap_threshold; // Blocks at least this big are mapped straight from the OS, 0 for never
+    uint8_t sanitize_mode; // sn_sanitize_mode_e bits
+    size_t sanitize_max_size; // Blocks bigger than this are never sanitized, 0 for no limit
 
     size_t alloc_limit;
-    size_t global_memory_usage;
+    size_t committed; // Bytes in use plus every thread's budget, never above alloc_limit (only kept while a limit is set)
 
-    plat_mutex_c mutex_ref; //A reference to a pre-existing mutex Therefore not managed by this object
+    // Hits read lock it, anything that fills, empties or resizes the cache write locks it, no shard lock is taken while it is held
+    plat_rwlock_c cache_rwlock;
+    registry_c registry_ref; //The registry usage is summed from, also not managed by this object
 } *alloc_manager_m, alloc_manager_t;
 
 
-alloc_manager_m memman_new(plat_mutex_c mutex_ref);
+alloc_manager_m memman_new(registry_c registry_ref);
 
 void memman_destroy(alloc_manager_m self);
-void memman_work(alloc_manager_m self, linked_list_c list);
+void memman_work(alloc_manager_m self, registry_c registry);
+
+linked_list_entry_c memman_findEntry(alloc_manager_m self, registry_c registry, void* key);
+
+/*
+ * Every block gets a stamp no other block ever had when it enters the registry and loses it when it leaves
+ * The calling thread's lookup cache remembers the stamp next to the entry and only trusts a slot while they match,
+ * so a block freed (or a node reused) by any thread invalidates every thread's copy without touching them
+ */
+void memman_stampEntry(linked_list_entry_c entry);
+void memman_unstampEntry(linked_list_entry_c entry);
 
 linked_list_entry_c memman_TryCacheHit(alloc_manager_m self, void* key);
 linked_list_entry_c memman_TryCacheHitById(alloc_manager_m self, uint16_t id);
 void memman_cacheInvalidate(alloc_manager_m self, void* key);
 void memman_cacheClear(alloc_manager_m self);
+// Pins entry in the fast cache, fails if the cache is frozen or off or every slot of its set is pinned
 SN_FLAG memman_tryCachePut(alloc_manager_m self, linked_list_entry_c entry);
+// Swaps in an empty cache of about slots slots (rounded up to a power of two, at least one set), 0 on failure
+size_t memman_setCacheSize(alloc_manager_m self, size_t slots);
+size_t memman_getCacheSize(alloc_manager_m self);
 
+// Summed from the registry shards on demand, there is no global counter for every thread to fight over
 size_t memman_getGlobalMemoryUsage(alloc_manager_m self);
-void memman_setGlobalMemoryUsage(alloc_manager_m self, size_t global_memory_usage);
 
 size_t memman_getAllocLimit(alloc_manager_m self);
-void memman_setAllocLimit(alloc_manager_m self, size_t alloc_limit);
+// Takes every thread's budget back and restarts committed from what is in use now, call with no allocations in flight
+void memman_setAllocLimit(alloc_manager_m self, thread_usage_c usage_table, size_t alloc_limit);
+// Hands every thread's unspent budget back to the shared pool, safe with allocations in flight (threads just refill)
+void memman_reclaimBudgets(alloc_manager_m self, thread_usage_c usage_table);
+
+/*
+ * Enforces the alloc limit without a shared counter on the common path
+ * Allocations are paid out of the calling thread's budget, only when that runs out is the shared committed
+ * counter bumped, by a whole MEMMAN_BUDGET_CHUNK at a time, so blocks in use can never add up past the limit
+ * Freed bytes go into the freeing thread's budget and anything over two chunks is handed back
+ */
+SN_BOOL memman_reserve(alloc_manager_m self, thread_usage_c usage_table, thread_usage_record_t* record, size_t size);
+void memman_release(alloc_manager_m self, thread_usage_record_t* record, size_t size);
+// Counts size as in use without checking the limit (sn_register, the memory was never ours to refuse)
+void memman_charge(alloc_manager_m self, size_t size);
+
+// when is SN_SANITIZE_ON_FREE or SN_SANITIZE_ON_ALLOC
+SN_BOOL memman_shouldSanitize(alloc_manager_m self, sn_sanitize_mode_e when, size_t size);
 
 SN_BOOL memman_canAllocateBasedOnLimit(alloc_manager_m self);
 SN_BOOL memman_canAllocateBasedOnLimitAndSize(alloc_manager_m self, size_t size);
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * Direct mapped block id -> entry table
+ * Two levels of 256 so only the id ranges actually in use cost memory,
+ * pages are installed lazily and never freed until the table is destroyed
+ * Lookups are lock free, writers only race each other through CAS
+ * Each id also counts the blocks carrying it, so dropping the owner of an id nobody else has costs nothing
+ */
+
+#ifndef ID_TABLE_C_H
+#define ID_TABLE_C_H
+#include <stdint.h>
+#include "linked_list_c.h"
+
+#define ID_TABLE_PAGE_BITS 8
+#define ID_TABLE_PAGE_SLOTS (1 << ID_TABLE_PAGE_BITS)
+#define ID_TABLE_PAGE_COUNT ((UINT16_MAX + 1) >> ID_TABLE_PAGE_BITS)
+
+typedef struct id_table_page_s
+{
+    linked_list_entry_c slots[ID_TABLE_PAGE_SLOTS];
+    uint32_t holders[ID_TABLE_PAGE_SLOTS]; // Blocks carrying each id, owner included
+} id_table_page_t;
+
+typedef struct id_table_s
+{
+    id_table_page_t* pages[ID_TABLE_PAGE_COUNT];
+} *id_table_c, id_table_t;
+
+id_table_c id_table_new();
+void id_table_destroy(id_table_c self);
+
+// Makes entry the id's owner unless another block already is, fails only if the page can't be allocated
+SN_BOOL id_table_claim(id_table_c self, uint16_t id, linked_list_entry_c entry);
+linked_list_entry_c id_table_get(id_table_c self, uint16_t id);
+SN_BOOL id_table_clearIfOwner(id_table_c self, uint16_t id, linked_list_entry_c entry);
+
+// A block took the id on, fails only if the page can't be allocated
+SN_BOOL id_table_retain(id_table_c self, uint16_t id);
+// A block gave the id up, returns how many others still carry it
+uint32_t id_table_release(id_table_c self, uint16_t id);
+
+#endif //ID_TABLE_C_H
@@ -46,11 +46,18 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "platform_independent/plat_threading.h"
+#include "ptr_index_c.h"
+#include "addr_tree_c.h"
+#include "node_pool_c.h"
 #include "libsafetynet.h"
 
+struct thread_usage_record_s;
+struct tag_usage_node_s;
+
 typedef struct linked_list_entry_s
 {
     struct linked_list_entry_s* previous;
+    // data through block_id are what sn_query_metadata hands out as a sn_mem_metadata_t, they must stay in this order
     void* data;           // Pointer to data (generic data type)
     size_t size;          // size of the data
     sn_tid_t tid;         // The tid of the thread that allocated this chunk
@@ -58,12 +65,24 @@ typedef struct linked_list_entry_s
     uint16_t block_id;    // An optional block id
     // Do not create a getter nor a setter for this treat this as private
     SN_BOOL isHead;       // To be determined
-    uint8_t _weight;      // For used for caching(private)
-    plat_mutex_c mutex;   // A mutex inherited from the list container
+    uint8_t _weight;      // For used for caching(private), lookups bump it under the read lock so atomically
+    uint8_t flags;        // SN_BLOCK_FLAG_* bits describing how data was obtained (private)
+    uint8_t align_log2;   // Alignment data was allocated with when SN_BLOCK_FLAG_ALIGNED is set (private)
+    size_t usable;        // What size can grow to without the memory moving, see sn_block_queryUsable (private)
+    struct thread_usage_record_s* owner_usage; // Per thread counters this block is charged to (private)
+    struct tag_usage_node_s* tag;              // Allocation tag this block is charged to, NULL for none (private)
+    uint64_t generation;  // Unique stamp for this stay in the registry, 0 once it left, see memman_stampEntry (private)
+    node_pool_c pool;     // The pool this node was carved from, NULL if it came from plat_malloc (private)
+    struct linked_list_entry_s* addr_left;     // Address ordered tree links (private)
+    struct linked_list_entry_s* addr_right;
+    int8_t addr_height;
+    uint8_t backend;      // plat backend slot data was allocated from (private)
+    plat_rwlock_c rwlock; // The lock inherited from the list container
     struct linked_list_entry_s* next;
 } *linked_list_entry_c, linked_list_entry_t;
 
 linked_list_entry_c linked_list_entry_new(linked_list_entry_c previous, void* data, size_t size, sn_tid_t tid);
+linked_list_entry_c linked_list_entry_newFromPool(node_pool_c pool, linked_list_entry_c previous, void* data, size_t size, sn_tid_t tid);
 
 linked_list_entry_c linked_list_entry_getPreviousEntry(const linked_list_entry_c self);
 void linked_list_entry_setPreviousEntry(linked_list_entry_c self, linked_list_entry_c new_previous);
@@ -94,14 +113,27 @@ typedef struct linked_list_s
 {
     linked_list_entry_c head;
     size_t len;
+    size_t bytes; // Sum of every entry size, kept in sync by push/remove/resize
 
     linked_list_entry_c firstEntry; //Physical beginning
     linked_list_entry_c lastEntry; //Physical last
-    linked_list_entry_c lastAccess;
-    plat_mutex_c mutex; // Shared by all elements within this list container
+    linked_list_entry_c lastAccess; // Written by lookups holding just the read lock, so atomically
+    ptr_index_c index; // data pointer -> entry, kept in sync by push/remove
+    addr_tree_t addr_tree; // entries ordered by data address, kept in sync by push/remove
+    node_pool_c pool; // Every node pushed onto this list is carved from here
+    /*
+     * Shared by all elements within this list container
+     * Lookups and walks read lock it, anything that links, unlinks or rewrites an entry write locks it
+     * A forEach worker runs under the read lock, so it must not push, remove, use the entry setters or take it again
+     * Outside code never runs as one, sn_mem_metadata_for_each pins the entries and calls its worker unlocked
+     */
+    plat_rwlock_c rwlock;
 } *linked_list_c, linked_list_t;
 
 
+// Entries per pool page, about 32KiB worth
+#define LINKED_LIST_NODES_PER_PAGE 256
+
 #define LIST_FOR_EACH_LOOP_BRAKE ((linked_list_entry_c)-44)
 typedef linked_list_entry_c(*linked_list_for_each_worker_f)(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg);
 
@@ -109,18 +141,23 @@ linked_list_c linked_list_new();
 
 void linked_list_destroy(linked_list_c self);
 
-void linked_list_push(linked_list_c self, void* data, size_t size, uint64_t tid);
+linked_list_entry_c linked_list_push(linked_list_c self, void* data, size_t size, uint64_t tid);
+
+// linked_list_push for count blocks with one pool and one list lock, entry i for data[i] is written to out[i]
+void linked_list_pushBatch(linked_list_c self, void* const* data, const size_t* sizes, size_t count, sn_tid_t tid, linked_list_entry_c* out);
 linked_list_entry_c linked_list_peek(linked_list_c self);
 void linked_list_pop(linked_list_c self);
 
 linked_list_entry_c linked_list_getByPtr(linked_list_c self, void* key);
 linked_list_entry_c linked_list_getByIndex(linked_list_c self, size_t index);
 linked_list_entry_c linked_list_getById(linked_list_c self, uint16_t id);
+linked_list_entry_c linked_list_getContaining(linked_list_c self, const void* addr);
 
 SN_BOOL linked_list_hasPtr(linked_list_c self, void* key);
 SN_BOOL linked_list_hasId(linked_list_c self, uint16_t id);
 
 size_t linked_list_getSize(linked_list_c self);
+size_t linked_list_getBytes(linked_list_c self);
 
 linked_list_entry_c linked_list_forEach(linked_list_c self, linked_list_for_each_worker_f worker, void* generic_arg);
 
@@ -128,4 +165,15 @@ void linked_list_removeEntryByPtr(linked_list_c self, void* key);
 
 SN_BOOL linked_list_removeEntry(linked_list_c self, linked_list_entry_c entry_ref);
 
+// Unlinks every entry under one lock, then frees the nodes, the entries must all be in this list
+void linked_list_removeBatch(linked_list_c self, linked_list_entry_c* entries, size_t count);
+
+void linked_list_rekeyEntry(linked_list_c self, linked_list_entry_c entry_ref, void* new_data);
+void linked_list_resizeEntry(linked_list_c self, linked_list_entry_c entry_ref, size_t new_size);
+
+// Move an entry between lists without freeing it, the entry takes the new list's lock
+// attach (re)keys the entry with data under that lock, pass entry_ref->data to keep the key it had
+SN_BOOL linked_list_detachEntry(linked_list_c self, linked_list_entry_c entry_ref);
+void linked_list_attachEntry(linked_list_c self, linked_list_entry_c entry_ref, void* data);
+
 #endif
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * Fixed size object pool carved out of big pages
+ * Freed objects go on an intrusive free list and are handed out again first
+ * Pages are only released when the whole pool is destroyed, so a pointer into the pool
+ * always points at readable memory of the right shape while the pool lives
+ */
+
+#ifndef NODE_POOL_C_H
+#define NODE_POOL_C_H
+#include <stddef.h>
+#include "libsafetynet.h"
+#include "platform_independent/plat_threading.h"
+
+typedef struct node_pool_page_s
+{
+    struct node_pool_page_s* next;
+    uint8_t backend; // The plat backend slot the page came from
+} node_pool_page_t;
+
+typedef struct node_pool_s
+{
+    size_t object_size;
+    size_t objects_per_page;
+    void* free_list;          // Intrusive, the first word of a free object is the next one
+    node_pool_page_t* pages;
+    size_t page_count;
+    size_t live_count;
+    plat_mutex_c mutex;
+} *node_pool_c, node_pool_t;
+
+node_pool_c node_pool_new(size_t object_size, size_t objects_per_page);
+
+// Frees every page in one go, objects still handed out become invalid
+void node_pool_destroy(node_pool_c self);
+
+// Returns zeroed memory, NULL if a new page could not be allocated
+void* node_pool_alloc(node_pool_c self);
+void node_pool_free(node_pool_c self, void* object);
+
+// count objects under one lock, all or nothing (SN_FALSE and out untouched if the pool could not grow)
+SN_BOOL node_pool_allocBatch(node_pool_c self, void** out, size_t count);
+
+size_t node_pool_getLiveCount(node_pool_c self);
+size_t node_pool_getPageCount(node_pool_c self);
+
+#endif //NODE_POOL_C_H
@@ -23,11 +23,67 @@
 #ifndef SN_PLAT_ALLOCATORS_H
 #define SN_PLAT_ALLOCATORS_H
 #include <stddef.h>
+#include <stdint.h>
+#include "libsafetynet.h"
 
+// Library internals always come from these, only tracked blocks and registry nodes go through a backend
 void* plat_malloc(size_t size);
 void* plat_realloc(void* ptr, size_t new_size);
 void* plat_calloc(size_t num, size_t size);
 void  plat_free(void* ptr);
 
+// alignment must be a power of two, memory from here must go back through plat_aligned_free
+void* plat_aligned_alloc(size_t alignment, size_t size);
+void  plat_aligned_free(void* ptr);
+
+size_t plat_getPageSize();
+
+/*
+ * Anonymous zero filled mappings straight from the OS
+ * Lengths are passed back exactly as mapped (round them to plat_getPageSize yourself)
+ */
+void* plat_map(size_t length);
+void  plat_unmap(void* ptr, size_t length);
+// Grows/shrinks in place or moves the pages without copying where the OS can (mremap), copies otherwise
+void* plat_remap(void* ptr, size_t old_length, size_t new_length);
+// Best effort, a no-op where transparent huge pages don't exist
+void  plat_adviseHugePages(void* ptr, size_t length);
+
+// memset to zero, big regions are written with non temporal stores so clearing them doesn't flush the cache
+void  plat_clear(void* ptr, size_t size);
+/*
+ * Zeroes like plat_clear but hands whole pages inside the region back to the OS (MADV_DONTNEED) instead of writing them,
+ * they read back as zero on the next touch
+ * Only valid on private anonymous memory (the libc heap, plat_map), anything else must use plat_clear
+ */
+void  plat_discardPages(void* ptr, size_t size);
+
+/*
+ * Installable backends for tracked blocks and registry nodes
+ * Installed ops are copied into a slot that is never reused, so memory always goes back
+ * to the slot it came from (entries and node pages remember it) even after another backend is installed
+ */
+#define PLAT_BACKEND_SLOTS 8
+#define PLAT_BACKEND_LIBC 0 // Slot 0 is plain libc and is what everything starts on
+
+typedef enum
+{
+    PLAT_BACKEND_FOR_BLOCKS,
+    PLAT_BACKEND_FOR_NODES,
+    PLAT_BACKEND_USE_COUNT
+} plat_backend_use_e;
+
+const sn_backend_ops_t* plat_backend_getLibc();
+
+// Makes ops (NULL for libc) the backend for use, SN_FALSE if every slot is taken
+SN_BOOL plat_backend_install(plat_backend_use_e use, const sn_backend_ops_t* ops);
+uint8_t plat_backend_current(plat_backend_use_e use);
+
+void* plat_backend_malloc(uint8_t slot, size_t size);
+void* plat_backend_calloc(uint8_t slot, size_t num, size_t size);
+void* plat_backend_realloc(uint8_t slot, void* ptr, size_t new_size);
+void  plat_backend_free(uint8_t slot, void* ptr);
+// 0 if the backend can't tell
+size_t plat_backend_usableSize(uint8_t slot, void* ptr);
 
 #endif //SN_PLAT_ALLOCATORS_H
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * Thin wrappers over the compiler atomics so the lock free bits of the backend
+ * don't spell out builtins everywhere, works on any scalar or pointer lvalue
+ */
+
+#ifndef PLAT_ATOMIC_H
+#define PLAT_ATOMIC_H
+#include "libsafetynet_config.h"
+
+#if defined(SN_ON_GCC) || defined(SN_ON_CLANG)
+#   define plat_atomic_load(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#   define plat_atomic_load_relaxed(ptr) __atomic_load_n((ptr), __ATOMIC_RELAXED)
+#   define plat_atomic_store(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#   define plat_atomic_store_relaxed(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELAXED)
+#   define plat_atomic_exchange(ptr, val) __atomic_exchange_n((ptr), (val), __ATOMIC_ACQ_REL)
+#   define plat_atomic_cas(ptr, expected_ptr, desired) \
+        __atomic_compare_exchange_n((ptr), (expected_ptr), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#   define plat_atomic_fetch_add(ptr, val) __atomic_fetch_add((ptr), (val), __ATOMIC_RELAXED)
+#   define plat_atomic_fetch_sub(ptr, val) __atomic_fetch_sub((ptr), (val), __ATOMIC_RELAXED)
+#elif defined(SN_ON_MSVC)
+/*
+ * MSVC only has the _Interlocked* family, these dispatch on the operand size and hand back an __int64
+ * that the macros cast to the operand's own type again (needs __typeof__, MSVC 17.9 or newer)
+ */
+#   include <intrin.h>
+#   include <stddef.h>
+
+#   if defined(_M_ARM64)
+#       define PLAT_PRI_ATOMIC_FENCE() __dmb(_ARM64_BARRIER_ISH)
+#   else
+#       define PLAT_PRI_ATOMIC_FENCE() _ReadWriteBarrier() // Plain x86/x64 loads and stores already acquire and release
+#   endif
+
+static __forceinline __int64 plat_pri_atomicLoad(const volatile void* ptr, size_t size, int ordered)
+{
+    __int64 value;
+    switch (size)
+    {
+        case 1: value = *(const volatile char*)ptr; break;
+        case 2: value = *(const volatile short*)ptr; break;
+        case 4: value = *(const volatile long*)ptr; break;
+        default: value = *(const volatile __int64*)ptr; break;
+    }
+    if (ordered) PLAT_PRI_ATOMIC_FENCE();
+    return value;
+}
+
+static __forceinline void plat_pri_atomicStore(volatile void* ptr, __int64 value, size_t size, int ordered)
+{
+    if (ordered) PLAT_PRI_ATOMIC_FENCE();
+    switch (size)
+    {
+        case 1: *(volatile char*)ptr = (char)value; break;
+        case 2: *(volatile short*)ptr = (short)value; break;
+        case 4: *(volatile long*)ptr = (long)value; break;
+        default: *(volatile __int64*)ptr = value; break;
+    }
+}
+
+static __forceinline __int64 plat_pri_atomicExchange(volatile void* ptr, __int64 value, size_t size)
+{
+    switch (size)
+    {
+        case 1: return _InterlockedExchange8((volatile char*)ptr, (char)value);
+        case 2: return _InterlockedExchange16((volatile short*)ptr, (short)value);
+        case 4: return _InterlockedExchange((volatile long*)ptr, (long)value);
+        default: return _InterlockedExchange64((volatile __int64*)ptr, value);
+    }
+}
+
+static __forceinline __int64 plat_pri_atomicFetchAdd(volatile void* ptr, __int64 value, size_t size)
+{
+    switch (size)
+    {
+        case 1: return _InterlockedExchangeAdd8((volatile char*)ptr, (char)value);
+        case 2: return _InterlockedExchangeAdd16((volatile short*)ptr, (short)value);
+        case 4: return _InterlockedExchangeAdd((volatile long*)ptr, (long)value);
+        default: return _InterlockedExchangeAdd64((volatile __int64*)ptr, value);
+    }
+}
+
+// Same contract as __atomic_compare_exchange_n, on failure *expected gets what was there
+static __forceinline int plat_pri_atomicCas(volatile void* ptr, void* expected, __int64 desired, size_t size)
+{
+    __int64 old;
+    __int64 seen;
+    switch (size)
+    {
+        case 1: old = *(char*)expected; seen = _InterlockedCompareExchange8((volatile char*)ptr, (char)desired, (char)old); break;
+        case 2: old = *(short*)expected; seen = _InterlockedCompareExchange16((volatile short*)ptr, (short)desired, (short)old); break;
+        case 4: old = *(long*)expected; seen = _InterlockedCompareExchange((volatile long*)ptr, (long)desired, (long)old); break;
+        default: old = *(__int64*)expected; seen = _InterlockedCompareExchange64((volatile __int64*)ptr, desired, old); break;
+    }
+    if (seen == old) return 1;
+    plat_pri_atomicStore(expected, seen, size, 0);
+    return 0;
+}
+
+#   define plat_atomic_load(ptr) ((__typeof__(*(ptr)))plat_pri_atomicLoad((ptr), sizeof(*(ptr)), 1))
+#   define plat_atomic_load_relaxed(ptr) ((__typeof__(*(ptr)))plat_pri_atomicLoad((ptr), sizeof(*(ptr)), 0))
+#   define plat_atomic_store(ptr, val) plat_pri_atomicStore((void*)(ptr), (__int64)(val), sizeof(*(ptr)), 1)
+#   define plat_atomic_store_relaxed(ptr, val) plat_pri_atomicStore((void*)(ptr), (__int64)(val), sizeof(*(ptr)), 0)
+#   define plat_atomic_exchange(ptr, val) ((__typeof__(*(ptr)))plat_pri_atomicExchange((void*)(ptr), (__int64)(val), sizeof(*(ptr))))
+#   define plat_atomic_cas(ptr, expected_ptr, desired) \
+        plat_pri_atomicCas((void*)(ptr), (expected_ptr), (__int64)(desired), sizeof(*(ptr)))
+#   define plat_atomic_fetch_add(ptr, val) ((__typeof__(*(ptr)))plat_pri_atomicFetchAdd((void*)(ptr), (__int64)(val), sizeof(*(ptr))))
+#   define plat_atomic_fetch_sub(ptr, val) ((__typeof__(*(ptr)))plat_pri_atomicFetchAdd((void*)(ptr), -(__int64)(val), sizeof(*(ptr))))
+#else
+#   error "Unsupported compiler for plat_atomic"
+#endif
+
+#endif //PLAT_ATOMIC_H
@@ -23,7 +23,29 @@
 #ifndef PLAT_THREADING_H
 #define PLAT_THREADING_H
 #include <stdint.h>
+#include "libsafetynet_config.h"
 
+#if defined(SN_ON_GCC) || defined(SN_ON_CLANG)
+#   define plat_thread_local __thread
+#elif defined(SN_ON_MSVC)
+#   define plat_thread_local __declspec(thread)
+#else
+#   error "Unsupported compiler for plat_thread_local"
+#endif
+
+/*
+ * For a few pointer sized variables touched on every call, skips the __tls_get_addr call a shared object pays otherwise
+ * Static TLS space for libraries loaded with dlopen is scarce, don't put anything big behind this
+ */
+#if (defined(SN_ON_GCC) || defined(SN_ON_CLANG)) && defined(SN_ON_UNIX)
+#   define plat_thread_local_hot __thread __attribute__((tls_model("initial-exec")))
+#else
+#   define plat_thread_local_hot plat_thread_local
+#endif
+
+/*
+ * Recursive, a thread that already holds it can lock it again and has to unlock it as many times
+ */
 typedef struct plat_mutex_s* plat_mutex_c, plat_mutex_t;
 
 plat_mutex_c plat_mutex_new();
@@ -31,6 +53,53 @@ void plat_mutex_lock(plat_mutex_c self);
 void plat_mutex_unlock(plat_mutex_c self);
 void plat_mutex_destroy(plat_mutex_c self);
 
+/*
+ * Many readers or one writer, for state that is looked at far more often than it is changed
+ * Not recursive, taking the write side while holding either side deadlocks
+ * Writers are preferred, a waiting writer holds off new readers, so a thread must not stack read locks either
+ */
+typedef struct plat_rwlock_s* plat_rwlock_c, plat_rwlock_t;
+
+plat_rwlock_c plat_rwlock_new();
+void plat_rwlock_destroy(plat_rwlock_c self);
+void plat_rwlock_readLock(plat_rwlock_c self);
+void plat_rwlock_readUnlock(plat_rwlock_c self);
+void plat_rwlock_writeLock(plat_rwlock_c self);
+void plat_rwlock_writeUnlock(plat_rwlock_c self);
+
 uint64_t plat_getTid();
 
+/*
+ * A per thread slot whose destructor runs with the slot's value when a thread exits
+ * (only threads that set a non NULL value, and never for the thread that unloads the library)
+ */
+typedef void (*plat_tls_destructor_f)(void* value);
+typedef struct plat_tls_key_s* plat_tls_key_c, plat_tls_key_t;
+
+plat_tls_key_c plat_tls_key_new(plat_tls_destructor_f destructor);
+void plat_tls_key_destroy(plat_tls_key_c self);
+void plat_tls_set(plat_tls_key_c self, void* value);
+void* plat_tls_get(plat_tls_key_c self);
+
+/*
+ * A plain worker thread, plat_thread_join waits for it and frees the handle
+ * Without SN_CONFIG_ENABLE_MUTEX there are no threads, plat_thread_new always returns NULL
+ */
+typedef void (*plat_thread_f)(void* arg);
+typedef struct plat_thread_s* plat_thread_c, plat_thread_t;
+
+plat_thread_c plat_thread_new(plat_thread_f func, void* arg);
+void plat_thread_join(plat_thread_c self);
+
+/*
+ * An auto reset event, a signal wakes one waiter (or the next one to wait if nobody is)
+ * plat_event_wait returns 1 if it was signalled and 0 if timeout_ms ran out first
+ */
+typedef struct plat_event_s* plat_event_c, plat_event_t;
+
+plat_event_c plat_event_new();
+void plat_event_destroy(plat_event_c self);
+void plat_event_signal(plat_event_c self);
+int plat_event_wait(plat_event_c self, uint32_t timeout_ms);
+
 #endif //PLAT_THREADING_H
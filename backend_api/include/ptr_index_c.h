@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * Open addressing (linear probing) hash index mapping a pointer key to a generic value
+ * The index itself is not thread safe, the owner is expected to guard it
+ * NULL is used as the empty slot marker so NULL keys can not be indexed
+ */
+
+#ifndef PTR_INDEX_C_H
+#define PTR_INDEX_C_H
+#include <stddef.h>
+#include "libsafetynet.h"
+
+#define PTR_INDEX_MIN_CAPACITY 64
+
+typedef struct ptr_index_slot_s
+{
+    void* key;
+    void* value;
+} ptr_index_slot_t;
+
+typedef struct ptr_index_s
+{
+    ptr_index_slot_t* slots;
+    size_t capacity; // Always a power of two
+    size_t count;
+} *ptr_index_c, ptr_index_t;
+
+ptr_index_c ptr_index_new(size_t initial_capacity);
+void ptr_index_destroy(ptr_index_c self);
+
+// Fails if key is already in the index (or the table couldn't grow), it never replaces a value
+SN_BOOL ptr_index_put(ptr_index_c self, void* key, void* value);
+void* ptr_index_get(ptr_index_c self, const void* key);
+void* ptr_index_remove(ptr_index_c self, const void* key);
+
+size_t ptr_index_getCount(ptr_index_c self);
+
+#endif //PTR_INDEX_C_H
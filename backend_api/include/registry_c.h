@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * The block registry split into address hashed shards
+ * Each shard is a full linked_list_c with its own mutex, index, tree and counters
+ * so threads working on different blocks rarely touch the same lock
+ * Anything global (totals, for each, containing lookups) walks every shard
+ */
+
+#ifndef REGISTRY_C_H
+#define REGISTRY_C_H
+#include <stddef.h>
+#include <stdint.h>
+#include "libsafetynet_config.h"
+#include "linked_list_c.h"
+
+#ifndef SN_CONFIG_REGISTRY_SHARD_COUNT
+#   define SN_CONFIG_REGISTRY_SHARD_COUNT 16
+#endif
+
+#define REGISTRY_SHARD_COUNT SN_CONFIG_REGISTRY_SHARD_COUNT
+
+// Batches are split by shard this many blocks at a time, the scratch space lives on the stack
+#define REGISTRY_BATCH_CHUNK 128
+
+typedef struct registry_s
+{
+    linked_list_c shards[REGISTRY_SHARD_COUNT];
+} *registry_c, registry_t;
+
+registry_c registry_new();
+void registry_destroy(registry_c self);
+
+linked_list_c registry_getShard(registry_c self, const void* key);
+
+linked_list_entry_c registry_push(registry_c self, void* data, size_t size, sn_tid_t tid);
+SN_BOOL registry_removeEntry(registry_c self, linked_list_entry_c entry_ref);
+
+// Each shard's lock is taken once per REGISTRY_BATCH_CHUNK blocks instead of once per block
+void registry_pushBatch(registry_c self, void* const* data, const size_t* sizes, size_t count, sn_tid_t tid, linked_list_entry_c* out);
+void registry_removeBatch(registry_c self, linked_list_entry_c* entries, size_t count);
+
+// Moves the entry to the shard of new_data if needed
+void registry_rekeyEntry(registry_c self, linked_list_entry_c entry_ref, void* new_data);
+void registry_resizeEntry(registry_c self, linked_list_entry_c entry_ref, size_t new_size);
+
+// Take an entry out without freeing its node and put it back later (keyed by whatever data is by then)
+SN_BOOL registry_detachEntry(registry_c self, linked_list_entry_c entry_ref);
+void registry_attachEntry(registry_c self, linked_list_entry_c entry_ref);
+
+linked_list_entry_c registry_getByPtr(registry_c self, void* key);
+linked_list_entry_c registry_getById(registry_c self, uint16_t id);
+linked_list_entry_c registry_getContaining(registry_c self, const void* addr);
+SN_BOOL registry_hasPtr(registry_c self, void* key);
+
+// Totals summed over every shard, not a consistent snapshot while other threads allocate
+size_t registry_getSize(registry_c self);
+size_t registry_getBytes(registry_c self);
+
+// Same contract as linked_list_forEach, index counts across shards and a LIST_FOR_EACH_LOOP_BRAKE stops every shard
+linked_list_entry_c registry_forEach(registry_c self, linked_list_for_each_worker_f worker, void* generic_arg);
+
+#endif //REGISTRY_C_H
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * Helpers for how a tracked block's memory is laid out and given back
+ * Anything that needs the real allocation behind entry->data should go through here
+ */
+
+#ifndef SN_BLOCK_H
+#define SN_BLOCK_H
+#include <stdint.h>
+#include "linked_list_c.h"
+
+#define SN_BLOCK_FLAG_INLINE_HEADER 0x01 // data is preceded by a sn_block_header_t
+#define SN_BLOCK_FLAG_SIZE_CLASS 0x02    // Allocated with thread_cache_classSize bytes, may be parked in a thread cache
+#define SN_BLOCK_FLAG_ALIGNED 0x04       // From plat_aligned_alloc with 1 << entry->align_log2, never has an inline header
+#define SN_BLOCK_FLAG_MAPPED 0x08        // From plat_map, sn_block_getMappedLength bytes long
+#define SN_BLOCK_FLAG_BATCH_FREED 0x10   // Already queued by the sn_free_batch in progress, catches a pointer listed twice
+
+#define SN_BLOCK_HEADER_MAGIC ((uintptr_t)0x5AFE7E7A5AFE7E7AULL)
+
+/*
+ * Kept to two words so the user pointer keeps the alignment malloc gave the base
+ * size/tid/block_id are read through the entry back pointer so there is nothing to keep in sync
+ */
+typedef struct sn_block_header_s
+{
+    linked_list_entry_c entry; // Back pointer into the registry
+    uintptr_t magic;           // SN_BLOCK_HEADER_MAGIC ^ user pointer ^ entry
+} sn_block_header_t;
+
+#define SN_BLOCK_HEADER_SIZE (sizeof(sn_block_header_t))
+
+void sn_block_headerInstall(void* user_ptr, linked_list_entry_c entry);
+void sn_block_headerClear(void* user_ptr);
+linked_list_entry_c sn_block_headerProbe(const void* user_ptr);
+
+void* sn_block_getBase(linked_list_entry_c entry);
+
+// Gives the block's memory back to whichever plat allocator it came from
+void sn_block_release(linked_list_entry_c entry);
+
+// The whole pages a mapping of size user bytes (plus header_size) takes
+size_t sn_block_mappedLength(size_t header_size, size_t size);
+size_t sn_block_getMappedLength(linked_list_entry_c entry);
+
+/*
+ * Asks wherever the block came from how many bytes past data are really there, for entry->usable
+ * Call it whenever the memory is (re)allocated, size classed blocks answer with their class so they still fit their bin
+ */
+size_t sn_block_queryUsable(linked_list_entry_c entry);
+
+// 0 if the block only has whatever alignment malloc gives
+size_t sn_block_getAlignment(linked_list_entry_c entry);
+
+// Blocks from at least this big get their whole pages dropped (plat_discardPages) rather than written when sanitized
+#define SN_BLOCK_DISCARD_MIN ((size_t)1024 * 1024)
+
+// Zeroes size bytes at ptr, may_discard if the memory is private anonymous (see plat_discardPages)
+void sn_block_clear(void* ptr, size_t size, SN_BOOL may_discard);
+
+// Zeroes the block's data the cheapest safe way, mapped blocks are skipped as unmapping already hands back zero pages
+void sn_block_sanitize(linked_list_entry_c entry);
+
+#endif //SN_BLOCK_H
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * Per thread event counters for sn_get_stats
+ * Every thread bumps a block of its own with plain relaxed stores, reading sums every block
+ * Blocks are never freed, a thread that exits hands its block (and what it counted) to the next new thread
+ * Usable from anywhere including plat_threading, it takes no locks
+ */
+
+#ifndef STATS_C_H
+#define STATS_C_H
+#include <stdint.h>
+#include "libsafetynet.h"
+#include "platform_independent/plat_atomic.h"
+#include "platform_independent/plat_threading.h"
+
+typedef enum
+{
+    STATS_CACHE_HIT = 0,       // Shared fast cache had the block
+    STATS_CACHE_MISS,          // Shared fast cache was asked and did not
+    STATS_CACHE_EVICTION,      // A block lost its fast cache slot to make room
+    STATS_CACHE_PIN,           // A block was pinned in the fast cache
+    STATS_LOOKUP_HEADER,       // Lookup answered by an inline block header
+    STATS_LOOKUP_THREAD_CACHE, // Lookup answered by the calling thread's lookup cache
+    STATS_LOOKUP_CACHE,        // Lookup answered by the shared fast cache
+    STATS_LOOKUP_INDEX,        // Lookup that went to the registry's pointer index or address tree
+    STATS_LOOKUP_SCAN,         // Lookup that had to walk registry entries one by one
+    STATS_SCAN_STEP,           // An entry such a walk looked at
+    STATS_LOCK_ACQUIRE,        // plat mutex acquisitions
+    STATS_LOCK_CONTENDED,      // Of those, the ones that found it held and had to wait
+    STATS_COUNTER_COUNT
+} stats_counter_e;
+
+typedef struct stats_block_s
+{
+    uint64_t counters[STATS_COUNTER_COUNT];
+    SN_FLAG in_use;                    // Owned by a live thread
+    struct stats_block_s* next;        // Every block ever made, newest first
+} stats_block_t;
+
+// Sets up the thread exit hook that recycles blocks, counting works before this just without recycling
+SN_BOOL stats_init();
+void stats_shutdown();
+
+// The calling thread's block, NULL until it first counts something (private, use stats_add)
+extern plat_thread_local_hot stats_block_t* stats_local;
+stats_block_t* stats_pri_claimLocal();
+
+// Inline, it sits on every lookup and lock
+SN_FORCE_INLINE void stats_add(stats_counter_e counter, uint64_t amount)
+{
+    stats_block_t* block = stats_local;
+    if (!block)
+    {
+        block = stats_pri_claimLocal();
+        if (!block) return;
+    }
+
+    // Only this thread writes its block, no need for a locked add
+    plat_atomic_store_relaxed(&block->counters[counter], plat_atomic_load_relaxed(&block->counters[counter]) + amount);
+}
+#define stats_inc(counter) stats_add((counter), 1)
+
+// Sums every block into out (STATS_COUNTER_COUNT entries)
+void stats_sum(uint64_t* out);
+
+// Raises the recorded peaks if bytes/blocks are above them
+void stats_notePeak(size_t bytes, size_t blocks);
+void stats_getPeak(size_t* bytes, size_t* blocks);
+
+#endif //STATS_C_H
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+//
+#pragma once
+
+/*
+ * Tree of allocation tags with running counters
+ * A tag's counters include every tag below it, so charging walks up to the root
+ * which is bounded by TAG_USAGE_MAX_DEPTH and keeps the allocation path O(1)
+ * Nodes live until the table is destroyed, entries point straight at the tag they are charged to
+ */
+
+#ifndef TAG_USAGE_C_H
+#define TAG_USAGE_C_H
+#include <stddef.h>
+#include <stdint.h>
+#include "libsafetynet.h"
+#include "platform_independent/plat_threading.h"
+
+#define TAG_USAGE_MAX_DEPTH SN_TAG_MAX_DEPTH
+#define TAG_USAGE_NAME_MAX SN_TAG_NAME_MAX
+
+typedef struct tag_usage_node_s
+{
+    char name[TAG_USAGE_NAME_MAX];
+    struct tag_usage_node_s* parent;
+    uint8_t depth;                  // 1 for a root tag
+    size_t bytes;
+    size_t blocks;
+    size_t peak_bytes;
+    size_t limit;                   // 0 for none, checked against bytes (descendants included)
+    struct tag_usage_node_s* next;  // Every node, newest first
+} tag_usage_node_t;
+
+typedef struct tag_usage_s
+{
+    tag_usage_node_t* nodes;
+    size_t node_count;
+    plat_mutex_c mutex;
+} *tag_usage_c, tag_usage_t;
+
+tag_usage_c tag_usage_new();
+void tag_usage_destroy(tag_usage_c self);
+
+// Finds or creates name under parent (NULL for a root), NULL if the tree would get deeper than TAG_USAGE_MAX_DEPTH
+tag_usage_node_t* tag_usage_getNode(tag_usage_c self, tag_usage_node_t* parent, const char* name);
+
+// Adds bytes to node and each ancestor, undoing it all and returning SN_FALSE if any of them would pass its limit
+SN_BOOL tag_usage_tryCharge(tag_usage_node_t* node, size_t bytes);
+void tag_usage_charge(tag_usage_node_t* node, size_t bytes, size_t blocks);
+void tag_usage_uncharge(tag_usage_node_t* node, size_t bytes, size_t blocks);
+
+size_t tag_usage_snapshot(tag_usage_c self, sn_tag_usage_t* out, size_t max_count);
+
+#endif //TAG_USAGE_C_H
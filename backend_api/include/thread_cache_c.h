@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * Per thread bins of freed small blocks waiting to be handed out again
+ * A parked block keeps its memory and its registry node but is out of the registry,
+ * so to everything else it is just as freed as a block that went back to libc
+ * Records are only touched by their own thread, the table mutex only guards the record list
+ * which exists so exit and library unload can drain every bin
+ */
+
+#ifndef THREAD_CACHE_C_H
+#define THREAD_CACHE_C_H
+#include <stddef.h>
+#include <stdint.h>
+#include "libsafetynet.h"
+#include "linked_list_c.h"
+#include "platform_independent/plat_threading.h"
+
+#define THREAD_CACHE_MAX_BLOCK_SIZE 256
+#define THREAD_CACHE_GRANULE 16
+#define THREAD_CACHE_CLASS_COUNT (THREAD_CACHE_MAX_BLOCK_SIZE / THREAD_CACHE_GRANULE)
+#define THREAD_CACHE_BIN_DEPTH 32 // Blocks kept per size class per thread, at most ~70KiB a thread
+
+typedef struct thread_cache_record_s
+{
+    linked_list_entry_c bins[THREAD_CACHE_CLASS_COUNT]; // Chained through entry->next
+    uint8_t counts[THREAD_CACHE_CLASS_COUNT];
+    struct thread_cache_s* owner;
+    struct thread_cache_record_s* previous;
+    struct thread_cache_record_s* next;
+} thread_cache_record_t;
+
+typedef struct thread_cache_s
+{
+    thread_cache_record_t* records;
+    plat_tls_key_c key; // Drains a thread's record when it exits
+    plat_mutex_c mutex;
+} *thread_cache_c, thread_cache_t;
+
+thread_cache_c thread_cache_new();
+
+// Frees every parked block (and its node) of every thread
+void thread_cache_destroy(thread_cache_c self);
+
+// The calling thread's record, created on first use
+thread_cache_record_t* thread_cache_getRecord(thread_cache_c self);
+
+// The capacity blocks of this size are allocated with so they can share a bin, 0 if too big to cache
+size_t thread_cache_classSize(size_t size);
+
+SN_BOOL thread_cache_recordHasRoom(const thread_cache_record_t* record, size_t size);
+SN_BOOL thread_cache_recordPut(thread_cache_record_t* record, linked_list_entry_c entry);
+linked_list_entry_c thread_cache_recordTake(thread_cache_record_t* record, size_t size);
+
+#endif //THREAD_CACHE_C_H
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#pragma once
+
+/*
+ * Running per thread memory counters
+ * Records are created once per tid and live until the table is destroyed,
+ * so entries can point straight at the record they are charged to
+ * and charging/uncharging is just atomics, only record creation and lookups by tid lock
+ */
+
+#ifndef THREAD_USAGE_C_H
+#define THREAD_USAGE_C_H
+#include <stddef.h>
+#include "libsafetynet.h"
+#include "ptr_index_c.h"
+#include "platform_independent/plat_threading.h"
+
+typedef struct thread_usage_record_s
+{
+    sn_tid_t tid;
+    size_t bytes;
+    size_t blocks;
+    size_t peak_bytes;
+    size_t budget; // Bytes already reserved against the alloc limit this thread may still allocate, see memman_reserve
+    struct thread_usage_record_s* next; // Every record, newest first
+} thread_usage_record_t;
+
+typedef struct thread_usage_s
+{
+    ptr_index_c by_tid;
+    thread_usage_record_t* records;
+    size_t record_count;
+    plat_mutex_c mutex;
+} *thread_usage_c, thread_usage_t;
+
+thread_usage_c thread_usage_new();
+void thread_usage_destroy(thread_usage_c self);
+
+thread_usage_record_t* thread_usage_getRecord(thread_usage_c self, sn_tid_t tid);
+thread_usage_record_t* thread_usage_findRecord(thread_usage_c self, sn_tid_t tid);
+
+void thread_usage_recordCharge(thread_usage_record_t* record, size_t bytes, size_t blocks);
+void thread_usage_recordUncharge(thread_usage_record_t* record, size_t bytes, size_t blocks);
+
+size_t thread_usage_snapshot(thread_usage_c self, sn_thread_memory_usage_t* out, size_t max_count);
+
+#endif //THREAD_USAGE_C_H
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#include "addr_tree_c.h"
+
+#include <stdint.h>
+
+#include "linked_list_c.h"
+
+static int8_t addr_tree_pri_height(const linked_list_entry_c node)
+{
+    return node ? node->addr_height : 0;
+}
+
+static void addr_tree_pri_update(linked_list_entry_c node)
+{
+    const int8_t left = addr_tree_pri_height(node->addr_left);
+    const int8_t right = addr_tree_pri_height(node->addr_right);
+    node->addr_height = (int8_t)(1 + (left > right ? left : right));
+}
+
+static linked_list_entry_c addr_tree_pri_rotateRight(linked_list_entry_c node)
+{
+    linked_list_entry_c pivot = node->addr_left;
+    node->addr_left = pivot->addr_right;
+    pivot->addr_right = node;
+    addr_tree_pri_update(node);
+    addr_tree_pri_update(pivot);
+    return pivot;
+}
+
+static linked_list_entry_c addr_tree_pri_rotateLeft(linked_list_entry_c node)
+{
+    linked_list_entry_c pivot = node->addr_right;
+    node->addr_right = pivot->addr_left;
+    pivot->addr_left = node;
+    addr_tree_pri_update(node);
+    addr_tree_pri_update(pivot);
+    return pivot;
+}
+
+static linked_list_entry_c addr_tree_pri_balance(linked_list_entry_c node)
+{
+    addr_tree_pri_update(node);
+    const int balance = addr_tree_pri_height(node->addr_left) - addr_tree_pri_height(node->addr_right);
+
+    if (balance > 1)
+    {
+        if (addr_tree_pri_height(node->addr_left->addr_left) < addr_tree_pri_height(node->addr_left->addr_right))
+            node->addr_left = addr_tree_pri_rotateLeft(node->addr_left);
+        return addr_tree_pri_rotateRight(node);
+    }
+
+    if (balance < -1)
+    {
+        if (addr_tree_pri_height(node->addr_right->addr_right) < addr_tree_pri_height(node->addr_right->addr_left))
+            node->addr_right = addr_tree_pri_rotateRight(node->addr_right);
+        return addr_tree_pri_rotateLeft(node);
+    }
+
+    return node;
+}
+
+// Ordered by data, ties (sn_register allows duplicate keys) broken by the entry address
+static int addr_tree_pri_compare(const linked_list_entry_c a, const linked_list_entry_c b)
+{
+    if (a->data != b->data)
+        return (uintptr_t)a->data < (uintptr_t)b->data ? -1 : 1;
+    if (a == b) return 0;
+    return (uintptr_t)a < (uintptr_t)b ? -1 : 1;
+}
+
+static linked_list_entry_c addr_tree_pri_insert(linked_list_entry_c node, linked_list_entry_c entry)
+{
+    if (!node)
+    {
+        entry->addr_left = NULL;
+        entry->addr_right = NULL;
+        entry->addr_height = 1;
+        return entry;
+    }
+
+    if (addr_tree_pri_compare(entry, node) < 0)
+        node->addr_left = addr_tree_pri_insert(node->addr_left, entry);
+    else
+        node->addr_right = addr_tree_pri_insert(node->addr_right, entry);
+
+    return addr_tree_pri_balance(node);
+}
+
+static linked_list_entry_c addr_tree_pri_removeMin(linked_list_entry_c node, linked_list_entry_c* out_min)
+{
+    if (!node->addr_left)
+    {
+        *out_min = node;
+        return node->addr_right;
+    }
+    node->addr_left = addr_tree_pri_removeMin(node->addr_left, out_min);
+    return addr_tree_pri_balance(node);
+}
+
+static linked_list_entry_c addr_tree_pri_remove(linked_list_entry_c node, linked_list_entry_c entry, SN_BOOL* removed)
+{
+    if (!node) return NULL;
+
+    const int cmp = addr_tree_pri_compare(entry, node);
+    if (cmp < 0)
+    {
+        node->addr_left = addr_tree_pri_remove(node->addr_left, entry, removed);
+    }
+    else if (cmp > 0)
+    {
+        node->addr_right = addr_tree_pri_remove(node->addr_right, entry, removed);
+    }
+    else
+    {
+        linked_list_entry_c left = node->addr_left;
+        linked_list_entry_c right = node->addr_right;
+        node->addr_left = NULL;
+        node->addr_right = NULL;
+        node->addr_height = 0;
+        *removed = SN_TRUE;
+
+        if (!right) return left;
+
+        linked_list_entry_c successor = NULL;
+        right = addr_tree_pri_removeMin(right, &successor);
+        successor->addr_left = left;
+        successor->addr_right = right;
+        return addr_tree_pri_balance(successor);
+    }
+
+    return addr_tree_pri_balance(node);
+}
+
+void addr_tree_insert(addr_tree_t* self, linked_list_entry_c entry)
+{
+    if (!self || !entry || !entry->data) return;
+    self->root = addr_tree_pri_insert(self->root, entry);
+    self->count++;
+}
+
+void addr_tree_remove(addr_tree_t* self, linked_list_entry_c entry)
+{
+    if (!self || !entry || !entry->data) return;
+
+    SN_BOOL removed = SN_FALSE;
+    self->root = addr_tree_pri_remove(self->root, entry, &removed);
+    if (removed)
+        self->count--;
+}
+
+linked_list_entry_c addr_tree_floor(const addr_tree_t* self, const void* addr)
+{
+    if (!self) return NULL;
+
+    linked_list_entry_c best = NULL;
+    linked_list_entry_c node = self->root;
+    while (node)
+    {
+        if ((uintptr_t)node->data <= (uintptr_t)addr)
+        {
+            best = node;
+            node = node->addr_right;
+        }
+        else
+        {
+            node = node->addr_left;
+        }
+    }
+    return best;
+}
@@ -23,18 +23,33 @@
 #include "allocation_manager/alloc_manager_c.h"
 #include "../../include/platform_independent/plat_allocators.h"
 #include "sn_crash.h"
+#include "sn_block.h"
+#include "platform_independent/plat_atomic.h"
+#include "stats_c.h"
 
-alloc_manager_m memman_new(plat_mutex_c mutex_ref)
+alloc_manager_m memman_new(registry_c registry_ref)
 {
     alloc_manager_m self = plat_malloc(sizeof(alloc_manager_t));
     if (!self) sn_crash(SN_ERR_CATASTROPHIC);
     memset(self, 0, sizeof(alloc_manager_t));
 
-    self->available_cache_slots = MEMMAN_MAX_CACHE_SLOTS;
-    self->global_memory_usage = MEMMAN_NO_ALLOC_LIMIT;
     self->cache_lock = 0;
     self->use_cache = 1;
-    self->mutex_ref = mutex_ref;
+#ifdef BUILDING_SAFETYNET_PRELOAD
+    // A parked block is no longer tracked, a second free of it would go on to glibc's free and get handed out twice
+    self->use_thread_cache = 0;
+#else
+    self->use_thread_cache = 1;
+#endif
+#ifdef SN_CONFIG_SANITIZE_MEMORY_ON_FREE
+    self->sanitize_mode = SN_SANITIZE_ON_FREE;
+#else
+    self->sanitize_mode = SN_SANITIZE_OFF;
+#endif
+    self->cache_rwlock = plat_rwlock_new();
+    if (!self->cache_rwlock) sn_crash(SN_ERR_CATASTROPHIC);
+    self->registry_ref = registry_ref;
+    if (!memman_setCacheSize(self, SN_CONFIG_FAST_CACHE_SLOTS)) sn_crash(SN_ERR_CATASTROPHIC);
 
     return self;
 }
@@ -42,67 +57,277 @@ alloc_manager_m memman_new(plat_mutex_c mutex_ref)
 void memman_destroy(alloc_manager_m self)
 {
     if (!self) return;
+    plat_free(self->cache_sets);
+    plat_rwlock_destroy(self->cache_rwlock);
     plat_free(self);
 }
 
+static cache_set_t* memman_pri_cacheSetOf(alloc_manager_m self, const void* key)
+{
+    if (self->cache_set_count == 1) return self->cache_sets;
+    const uint64_t h = (uint64_t)(uintptr_t)key * UINT64_C(11400714819323198485);
+    return &self->cache_sets[h >> self->cache_set_shift];
+}
+
+static cache_pair_t* memman_pri_cacheFind(cache_set_t* set, const void* key)
+{
+    for (size_t i = 0; i < MEMMAN_CACHE_WAYS; i++)
+    {
+        if (set->slots[i].key == key) return &set->slots[i];
+    }
+    return NULL;
+}
+
+static void memman_pri_cacheDrop(alloc_manager_m self, cache_pair_t* slot)
+{
+    slot->value->cached = 0;
+    memset(slot, 0, sizeof(cache_pair_t));
+    self->cache_used--;
+}
+
+/*
+ * A free slot if the set has one, otherwise CLOCK picks the victim
+ * The hand clears referenced bits as it passes, so a slot survives one sweep per hit, pinned slots are skipped
+ * Returns NULL when every slot is pinned
+ */
+static cache_pair_t* memman_pri_cacheClaim(alloc_manager_m self, cache_set_t* set)
+{
+    for (size_t i = 0; i < MEMMAN_CACHE_WAYS; i++)
+    {
+        if (!set->slots[i].key) return &set->slots[i];
+    }
+
+    for (size_t i = 0; i < 2 * MEMMAN_CACHE_WAYS; i++)
+    {
+        cache_pair_t* slot = &set->slots[set->hand];
+        set->hand = (uint8_t)((set->hand + 1) % MEMMAN_CACHE_WAYS);
+        if (slot->pinned) continue;
+        if (slot->referenced)
+        {
+            slot->referenced = 0;
+            continue;
+        }
+        memman_pri_cacheDrop(self, slot);
+        stats_inc(STATS_CACHE_EVICTION);
+        return slot;
+    }
+    return NULL;
+}
+
+static cache_pair_t* memman_pri_cacheInsert(alloc_manager_m self, linked_list_entry_c entry, void* key)
+{
+    cache_pair_t* slot = memman_pri_cacheClaim(self, memman_pri_cacheSetOf(self, key));
+    if (!slot) return NULL;
+
+    slot->key = key;
+    slot->value = entry;
+    slot->referenced = 0;
+    slot->pinned = 0;
+    entry->cached = 1;
+    self->cache_used++;
+    return slot;
+}
+
+typedef struct
+{
+    linked_list_entry_c entry;
+    void* key;
+    uint64_t generation;  // entry's stamp when the walk saw it
+} memman_pri_candidate_t;
+
+typedef struct
+{
+    memman_pri_candidate_t* candidates;
+    size_t count;
+    size_t capacity;
+} memman_pri_candidates_t;
+
 // ReSharper disable once CppDFAConstantFunctionResult
 static linked_list_entry_c memman_CacheAlgorithmWorker(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
 {
     if (!generic_arg) return NULL;
-    alloc_manager_m self_alloc_manager = (alloc_manager_m)generic_arg;
+    memman_pri_candidates_t* found = generic_arg;
 
-    if (ctx->_weight <= 10)
+    // Blocks looked up often enough since the last pass get a slot, then the weight decays so it tracks recent use
+    // The registry is only read locked here, lookups may be bumping the weight as we go
+    const uint8_t weight = plat_atomic_load_relaxed(&ctx->_weight);
+    if (weight >= MEMMAN_CACHE_PROMOTE_WEIGHT && found->count < found->capacity && !plat_atomic_load_relaxed(&ctx->cached))
     {
-        ctx->_weight = 0;
-        ctx->cached = 1;
-        for (size_t i = 0; i < MEMMAN_MAX_CACHE_SLOTS; i++)
+        const uint64_t generation = plat_atomic_load(&ctx->generation);
+        if (generation) // Not half inserted or on its way out
         {
-            if (self_alloc_manager->cache_list[i].value == NULL)
-            {
-                self_alloc_manager->cache_list[i].value = ctx;
-                self_alloc_manager->cache_list[i].value->cached = 1;
-                self_alloc_manager->cache_list[i].key = ctx->data;
-                return NULL;
-            }
-            if (self_alloc_manager->cache_list[i].value->_weight < 10)
-            {
-                self_alloc_manager->cache_list[i].value = ctx;
-                self_alloc_manager->cache_list[i].value->cached = 1;
-                self_alloc_manager->cache_list[i].key = ctx->data;
-                return NULL;
-            }
+            found->candidates[found->count++] = (memman_pri_candidate_t){
+                ctx,
+                ctx->data,
+                generation
+            };
         }
-        return NULL;
     }
+    plat_atomic_store_relaxed(&ctx->_weight, (uint8_t)(weight >> 1));
 
     return NULL;
 }
 
-void memman_work(alloc_manager_m self, linked_list_c list)
+void memman_work(alloc_manager_m self, registry_c registry)
 {
     if (!self) return;
-    if (!list) return;
-    plat_mutex_lock(self->mutex_ref);
-    linked_list_forEach(list, &memman_CacheAlgorithmWorker, self);
-    plat_mutex_unlock(self->mutex_ref);
+    if (!registry) return;
+    if (self->cache_lock || !self->use_cache) return; // Frozen or off, promotion is all a pass does
+
+    // More candidates than slots would only evict each other
+    memman_pri_candidates_t found = {
+        NULL,
+        0,
+        memman_getCacheSize(self)
+    };
+    found.candidates = plat_malloc(found.capacity * sizeof(memman_pri_candidate_t));
+    if (!found.candidates) return;
+
+    // cache_rwlock is never held while a shard lock is taken, so the walk is done before the cache is locked
+    registry_forEach(registry, &memman_CacheAlgorithmWorker, &found);
+
+    plat_rwlock_writeLock(self->cache_rwlock);
+    for (size_t i = 0; i < found.count; i++)
+    {
+        const memman_pri_candidate_t* candidate = &found.candidates[i];
+        // Freed, moved or cached since the walk saw it
+        if (candidate->entry->cached || plat_atomic_load(&candidate->entry->generation) != candidate->generation) continue;
+        memman_pri_cacheInsert(self, candidate->entry, candidate->key);
+    }
+    plat_rwlock_writeUnlock(self->cache_rwlock);
+
+    plat_free(found.candidates);
+}
+
+typedef struct memman_l1_slot_s
+{
+    void* key;
+    linked_list_entry_c entry;
+    uint64_t generation;  // entry's stamp when the slot was filled
+} memman_l1_slot_t;
+
+static plat_thread_local memman_l1_slot_t memman_l1[1 << MEMMAN_L1_BITS];
+
+static uint64_t memman_generation_source = 0;
+static plat_thread_local uint64_t memman_generation_next = 0;
+static plat_thread_local uint64_t memman_generation_end = 0;
+
+void memman_stampEntry(linked_list_entry_c entry)
+{
+    if (!entry) return;
+    if (memman_generation_next == memman_generation_end)
+    {
+        // Stamps start at 1, 0 is the unstamped value
+        memman_generation_next = plat_atomic_fetch_add(&memman_generation_source, MEMMAN_GENERATION_BATCH) + 1;
+        memman_generation_end = memman_generation_next + MEMMAN_GENERATION_BATCH;
+    }
+    plat_atomic_store(&entry->generation, memman_generation_next++);
+}
+
+void memman_unstampEntry(linked_list_entry_c entry)
+{
+    if (!entry) return;
+    plat_atomic_store(&entry->generation, 0);
+}
+
+static memman_l1_slot_t* memman_pri_l1SlotOf(const void* key)
+{
+    const uint64_t h = (uint64_t)(uintptr_t)key * UINT64_C(11400714819323198485);
+    return &memman_l1[h >> (64 - MEMMAN_L1_BITS)];
+}
+
+/*
+ * The one stop lookup every entry point should use
+ * inline header (if enabled) -> this thread's lookup cache -> fast cache -> registry index
+ */
+linked_list_entry_c memman_findEntry(alloc_manager_m self, registry_c registry, void* key)
+{
+    if (!key || !self || !registry) return NULL; // NULL before init and after shutdown
+#ifdef SN_CONFIG_ENABLE_INLINE_HEADER
+    if (self && self->use_inline_headers)
+    {
+        linked_list_entry_c entry = sn_block_headerProbe(key);
+        if (entry)
+        {
+            stats_inc(STATS_LOOKUP_HEADER);
+            return entry;
+        }
+    }
+#endif
+
+    // Entries are pool nodes that stay readable until shutdown, so a stale slot is safe to check
+    memman_l1_slot_t* slot = memman_pri_l1SlotOf(key);
+    if (slot->key == key)
+    {
+        if (plat_atomic_load(&slot->entry->generation) == slot->generation && plat_atomic_load_relaxed(&slot->entry->data) == key)
+        {
+            stats_inc(STATS_LOOKUP_THREAD_CACHE);
+            return slot->entry;
+        }
+        slot->key = NULL;
+    }
+
+    linked_list_entry_c entry = memman_TryCacheHit(self, key);
+    if (entry == MEMMAN_CACHE_MISS)
+    {
+        entry = registry_getByPtr(registry, key);
+        stats_inc(STATS_LOOKUP_INDEX);
+    }
+    else
+    {
+        stats_inc(STATS_LOOKUP_CACHE);
+    }
+
+    if (entry)
+    {
+        const uint64_t generation = plat_atomic_load(&entry->generation);
+        if (generation) // Still being inserted or already on its way out otherwise
+        {
+            slot->key = key;
+            slot->entry = entry;
+            slot->generation = generation;
+        }
+    }
+    return entry;
+}
+
+// An empty cache can't hit or need invalidating, don't make every thread touch cache_rwlock to find that out
+// A racy read is fine, a block only ever enters the cache after it was found through the registry
+static SN_BOOL memman_pri_cacheEmpty(alloc_manager_m self)
+{
+    return plat_atomic_load_relaxed(&self->cache_used) == 0;
+}
+
+/*
+ * memman_work installs what it found after the registry walk, a block freed in between can end up with a slot
+ * its free already looked for, so a hit only counts while the entry is still in the registry under that key
+ */
+static SN_BOOL memman_pri_cacheLive(linked_list_entry_c entry, const void* key)
+{
+    return plat_atomic_load(&entry->generation) && plat_atomic_load_relaxed(&entry->data) == key;
 }
 
 linked_list_entry_c memman_TryCacheHit(alloc_manager_m self, void* key)
 {
     if (!self) return MEMMAN_CACHE_MISS;
     if (!self->use_cache) return MEMMAN_CACHE_MISS;
-    plat_mutex_lock(self->mutex_ref);
-    for (size_t i = 0; i < MEMMAN_MAX_CACHE_SLOTS; i++)
+    if (memman_pri_cacheEmpty(self))
     {
-        if (!self->cache_list[i].key) continue;
-        if (self->cache_list[i].key == key)
-        {
-            self->cache_list[i].value->_weight++;
-            plat_mutex_unlock(self->mutex_ref);
-            return self->cache_list[i].value;
-        }
+        stats_inc(STATS_CACHE_MISS);
+        return MEMMAN_CACHE_MISS;
+    }
+    plat_rwlock_readLock(self->cache_rwlock);
+    cache_pair_t* slot = memman_pri_cacheFind(memman_pri_cacheSetOf(self, key), key);
+    if (slot && memman_pri_cacheLive(slot->value, key))
+    {
+        plat_atomic_store_relaxed(&slot->referenced, 1); // Only the read lock is held, other hits may set it too
+        linked_list_entry_c entry = slot->value;
+        plat_rwlock_readUnlock(self->cache_rwlock);
+        stats_inc(STATS_CACHE_HIT);
+        return entry;
     }
-    plat_mutex_unlock(self->mutex_ref);
+    plat_rwlock_readUnlock(self->cache_rwlock);
+    stats_inc(STATS_CACHE_MISS);
     return MEMMAN_CACHE_MISS;
 }
 
@@ -110,95 +335,214 @@ linked_list_entry_c memman_TryCacheHitById(alloc_manager_m self, uint16_t id)
 {
     if (!self) return MEMMAN_CACHE_MISS;
     if (!self->use_cache) return MEMMAN_CACHE_MISS;
-    plat_mutex_lock(self->mutex_ref);
-    for (size_t i = 0; i < MEMMAN_MAX_CACHE_SLOTS; i++)
+    if (memman_pri_cacheEmpty(self)) return MEMMAN_CACHE_MISS;
+    plat_rwlock_readLock(self->cache_rwlock);
+    // Ids don't hash to a set, this has to look at every slot
+    for (size_t i = 0; i < self->cache_set_count * MEMMAN_CACHE_WAYS; i++)
     {
-        if (!self->cache_list[i].value) continue;
-        if (self->cache_list[i].value->block_id == id)
+        cache_pair_t* slot = &self->cache_sets[i / MEMMAN_CACHE_WAYS].slots[i % MEMMAN_CACHE_WAYS];
+        if (slot->value && slot->value->block_id == id && memman_pri_cacheLive(slot->value, slot->key))
         {
-            plat_mutex_unlock(self->mutex_ref);
-            return self->cache_list[i].value;
+            plat_atomic_store_relaxed(&slot->referenced, 1);
+            linked_list_entry_c entry = slot->value;
+            plat_rwlock_readUnlock(self->cache_rwlock);
+            return entry;
         }
     }
-    plat_mutex_unlock(self->mutex_ref);
+    plat_rwlock_readUnlock(self->cache_rwlock);
     return MEMMAN_CACHE_MISS;
 }
 
 void memman_cacheInvalidate(alloc_manager_m self, void* key)
 {
     if (!self) return;
-    plat_mutex_lock(self->mutex_ref);
-    for (size_t i = 0; i < MEMMAN_MAX_CACHE_SLOTS; i++)
+    if (memman_pri_cacheEmpty(self)) return;
+    plat_rwlock_writeLock(self->cache_rwlock);
+    cache_pair_t* slot = memman_pri_cacheFind(memman_pri_cacheSetOf(self, key), key);
+    if (slot) memman_pri_cacheDrop(self, slot);
+    plat_rwlock_writeUnlock(self->cache_rwlock);
+}
+
+static void memman_pri_cacheDropAll(alloc_manager_m self)
+{
+    for (size_t i = 0; i < self->cache_set_count; i++)
     {
-        if (!self->cache_list[i].key) continue;
-        if (self->cache_list[i].key == key)
+        for (size_t j = 0; j < MEMMAN_CACHE_WAYS; j++)
         {
-            self->cache_list[i].value->cached = 0;
-            self->available_cache_slots++;
-            memset(&self->cache_list[i], 0, sizeof(cache_pair_t));
+            if (self->cache_sets[i].slots[j].key)
+                memman_pri_cacheDrop(self, &self->cache_sets[i].slots[j]);
         }
+        self->cache_sets[i].hand = 0;
     }
-    plat_mutex_unlock(self->mutex_ref);
 }
 
 void memman_cacheClear(alloc_manager_m self)
 {
     if (!self) return;
-    plat_mutex_lock(self->mutex_ref);
-    for (size_t i = 0; i < MEMMAN_MAX_CACHE_SLOTS; i++)
-    {
-        if (!self->cache_list[i].key) continue;
-        self->cache_list[i].value->cached = 1;
-        self->available_cache_slots++;
-        memset(&self->cache_list[i], 0, sizeof(cache_pair_t));
-    }
-    plat_mutex_unlock(self->mutex_ref);
+    plat_rwlock_writeLock(self->cache_rwlock);
+    memman_pri_cacheDropAll(self);
+    plat_rwlock_writeUnlock(self->cache_rwlock);
 }
 
 SN_FLAG memman_tryCachePut(alloc_manager_m self, linked_list_entry_c entry)
 {
-    if (!self) return 0;
+    if (!self || !entry) return 0;
     if (self->cache_lock || !self->use_cache) return 0;
-    if (self->available_cache_slots == 0) return 0;
-    plat_mutex_lock(self->mutex_ref);
+    plat_rwlock_writeLock(self->cache_rwlock);
+
+    cache_pair_t* slot = memman_pri_cacheFind(memman_pri_cacheSetOf(self, entry->data), entry->data);
+    if (!slot) slot = memman_pri_cacheInsert(self, entry, entry->data);
+    if (slot) slot->pinned = 1;
+
+    plat_rwlock_writeUnlock(self->cache_rwlock);
+    if (slot) stats_inc(STATS_CACHE_PIN);
+    return slot != NULL;
+}
 
-    for (size_t i = 0; i < MEMMAN_MAX_CACHE_SLOTS; i++)
+size_t memman_setCacheSize(alloc_manager_m self, size_t slots)
+{
+    if (!self) return 0;
+
+    size_t set_count = 1;
+    uint8_t set_bits = 0;
+    while (set_count * MEMMAN_CACHE_WAYS < slots && set_bits < 32)
     {
-        if (self->cache_list[i].key == NULL)
-        {
-            self->available_cache_slots--;
-            self->cache_list[i].key = entry->data;
-            self->cache_list[i].value = entry;
-            self->cache_list[i].value->cached = 1;
-            plat_mutex_unlock(self->mutex_ref);
-            return 1;
-        }
+        set_count <<= 1;
+        set_bits++;
     }
-    sn_crash(SN_ERR_SYS_FAIL);
+
+    cache_set_t* sets = plat_calloc(set_count, sizeof(cache_set_t));
+    if (!sets) return 0;
+
+    plat_rwlock_writeLock(self->cache_rwlock);
+    cache_set_t* old_sets = self->cache_sets;
+    if (old_sets) memman_pri_cacheDropAll(self);
+    self->cache_sets = sets;
+    self->cache_set_count = set_count;
+    self->cache_set_shift = (uint8_t)(64 - set_bits);
+    plat_rwlock_writeUnlock(self->cache_rwlock);
+
+    plat_free(old_sets);
+    return set_count * MEMMAN_CACHE_WAYS;
 }
 
-size_t memman_getGlobalMemoryUsage(alloc_manager_m self)
+size_t memman_getCacheSize(alloc_manager_m self)
 {
     if (!self) return 0;
-    return self->global_memory_usage;
+    return self->cache_set_count * MEMMAN_CACHE_WAYS;
 }
 
-void memman_setGlobalMemoryUsage(alloc_manager_m self, size_t global_memory_usage)
+size_t memman_getGlobalMemoryUsage(alloc_manager_m self)
 {
-    if (!self) return;
-    self->global_memory_usage = global_memory_usage;
+    if (!self) return 0;
+    return registry_getBytes(self->registry_ref);
 }
 
 size_t memman_getAllocLimit(alloc_manager_m self)
 {
     if (!self) return MEMMAN_NO_ALLOC_LIMIT;
-    return self->alloc_limit;
+    return plat_atomic_load_relaxed(&self->alloc_limit);
 }
 
-void memman_setAllocLimit(alloc_manager_m self, size_t alloc_limit)
+// Pulls the budget every thread is sitting on back into the shared pool
+void memman_reclaimBudgets(alloc_manager_m self, thread_usage_c usage_table)
+{
+    if (!self || !usage_table) return;
+
+    plat_mutex_lock(usage_table->mutex);
+    for (thread_usage_record_t* record = usage_table->records; record; record = record->next)
+    {
+        const size_t budget = plat_atomic_exchange(&record->budget, 0);
+        plat_atomic_fetch_sub(&self->committed, budget);
+    }
+    plat_mutex_unlock(usage_table->mutex);
+}
+
+void memman_setAllocLimit(alloc_manager_m self, thread_usage_c usage_table, size_t alloc_limit)
 {
     if (!self) return;
-    self->alloc_limit = alloc_limit;
+
+    plat_atomic_store(&self->alloc_limit, MEMMAN_NO_ALLOC_LIMIT);
+    memman_reclaimBudgets(self, usage_table);
+    plat_atomic_store(&self->committed, memman_getGlobalMemoryUsage(self));
+    plat_atomic_store(&self->alloc_limit, alloc_limit);
+}
+
+// Keeps the old rule, usage plus the new block must stay strictly under the limit
+static SN_BOOL memman_pri_commit(alloc_manager_m self, size_t limit, size_t amount)
+{
+    size_t committed = plat_atomic_load_relaxed(&self->committed);
+    do
+    {
+        if (amount >= limit || committed >= limit - amount) return SN_FALSE;
+    }
+    while (!plat_atomic_cas(&self->committed, &committed, committed + amount));
+    return SN_TRUE;
+}
+
+SN_BOOL memman_reserve(alloc_manager_m self, thread_usage_c usage_table, thread_usage_record_t* record, size_t size)
+{
+    if (!self) return SN_FALSE;
+    const size_t limit = memman_getAllocLimit(self);
+    if (limit == MEMMAN_NO_ALLOC_LIMIT) return SN_TRUE;
+    if (!record) return memman_pri_commit(self, limit, size);
+
+    // Only this thread and a reclaim ever touch its budget so this is an uncontended line
+    size_t budget = plat_atomic_load_relaxed(&record->budget);
+    while (budget >= size)
+    {
+        if (plat_atomic_cas(&record->budget, &budget, budget - size)) return SN_TRUE;
+    }
+
+    budget = plat_atomic_exchange(&record->budget, 0);
+    if (budget >= size)
+    {
+        plat_atomic_fetch_add(&record->budget, budget - size);
+        return SN_TRUE;
+    }
+
+    const size_t need = size - budget;
+    if (need <= SIZE_MAX - MEMMAN_BUDGET_CHUNK && memman_pri_commit(self, limit, need + MEMMAN_BUDGET_CHUNK))
+    {
+        plat_atomic_fetch_add(&record->budget, MEMMAN_BUDGET_CHUNK);
+        return SN_TRUE;
+    }
+
+    if (memman_pri_commit(self, limit, need)) return SN_TRUE;
+
+    // Threads that went quiet (or exited) may be holding what we need
+    memman_reclaimBudgets(self, usage_table);
+    if (memman_pri_commit(self, limit, need)) return SN_TRUE;
+
+    plat_atomic_fetch_add(&record->budget, budget);
+    return SN_FALSE;
+}
+
+void memman_release(alloc_manager_m self, thread_usage_record_t* record, size_t size)
+{
+    if (!self || !size || memman_getAllocLimit(self) == MEMMAN_NO_ALLOC_LIMIT) return;
+
+    if (!record)
+    {
+        plat_atomic_fetch_sub(&self->committed, size);
+        return;
+    }
+
+    size_t budget = plat_atomic_fetch_add(&record->budget, size) + size;
+    while (budget > 2 * MEMMAN_BUDGET_CHUNK)
+    {
+        if (plat_atomic_cas(&record->budget, &budget, MEMMAN_BUDGET_CHUNK))
+        {
+            plat_atomic_fetch_sub(&self->committed, budget - MEMMAN_BUDGET_CHUNK);
+            return;
+        }
+    }
+}
+
+void memman_charge(alloc_manager_m self, size_t size)
+{
+    if (!self || memman_getAllocLimit(self) == MEMMAN_NO_ALLOC_LIMIT) return;
+    plat_atomic_fetch_add(&self->committed, size);
 }
 
 SN_BOOL memman_canAllocateBasedOnLimit(alloc_manager_m self)
@@ -218,3 +562,9 @@ SN_BOOL memman_canAllocateBasedOnLimitAndSize(alloc_manager_m self, size_t size)
         return SN_FALSE;
     return SN_TRUE;
 }
+
+SN_BOOL memman_shouldSanitize(alloc_manager_m self, sn_sanitize_mode_e when, size_t size)
+{
+    if (!self || !(self->sanitize_mode & when)) return SN_FALSE;
+    return !self->sanitize_max_size || size <= self->sanitize_max_size;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#include "id_table_c.h"
+
+#include <string.h>
+
+#include "platform_independent/plat_allocators.h"
+#include "platform_independent/plat_atomic.h"
+
+id_table_c id_table_new()
+{
+    id_table_c self = plat_malloc(sizeof(id_table_t));
+    if (!self) return NULL;
+    memset(self, 0, sizeof(id_table_t));
+    return self;
+}
+
+void id_table_destroy(id_table_c self)
+{
+    if (!self) return;
+    for (size_t i = 0; i < ID_TABLE_PAGE_COUNT; i++)
+        plat_free(self->pages[i]);
+    plat_free(self);
+}
+
+static id_table_page_t* id_table_pri_getPage(id_table_c self, uint16_t id, SN_BOOL create)
+{
+    id_table_page_t** slot = &self->pages[id >> ID_TABLE_PAGE_BITS];
+    id_table_page_t* page = plat_atomic_load(slot);
+    if (page || !create) return page;
+
+    id_table_page_t* new_page = plat_calloc(1, sizeof(id_table_page_t));
+    if (!new_page) return NULL;
+
+    if (!plat_atomic_cas(slot, &page, new_page))
+    {
+        // Somebody beat us to it, page now holds theirs
+        plat_free(new_page);
+        return page;
+    }
+    return new_page;
+}
+
+SN_BOOL id_table_claim(id_table_c self, uint16_t id, linked_list_entry_c entry)
+{
+    if (!self) return SN_FALSE;
+    id_table_page_t* page = id_table_pri_getPage(self, id, SN_TRUE);
+    if (!page) return SN_FALSE;
+
+    // Whoever holds the slot keeps it, a failed swap is still a success
+    linked_list_entry_c expected = NULL;
+    plat_atomic_cas(&page->slots[id & (ID_TABLE_PAGE_SLOTS - 1)], &expected, entry);
+    return SN_TRUE;
+}
+
+linked_list_entry_c id_table_get(id_table_c self, uint16_t id)
+{
+    if (!self) return NULL;
+    id_table_page_t* page = id_table_pri_getPage(self, id, SN_FALSE);
+    if (!page) return NULL;
+
+    return plat_atomic_load(&page->slots[id & (ID_TABLE_PAGE_SLOTS - 1)]);
+}
+
+SN_BOOL id_table_clearIfOwner(id_table_c self, uint16_t id, linked_list_entry_c entry)
+{
+    if (!self) return SN_FALSE;
+    id_table_page_t* page = id_table_pri_getPage(self, id, SN_FALSE);
+    if (!page) return SN_FALSE;
+
+    // Only clear the slot if another block hasn't taken the id over
+    linked_list_entry_c expected = entry;
+    return plat_atomic_cas(&page->slots[id & (ID_TABLE_PAGE_SLOTS - 1)], &expected, NULL);
+}
+
+SN_BOOL id_table_retain(id_table_c self, uint16_t id)
+{
+    if (!self) return SN_FALSE;
+    id_table_page_t* page = id_table_pri_getPage(self, id, SN_TRUE);
+    if (!page) return SN_FALSE;
+
+    plat_atomic_fetch_add(&page->holders[id & (ID_TABLE_PAGE_SLOTS - 1)], 1);
+    return SN_TRUE;
+}
+
+uint32_t id_table_release(id_table_c self, uint16_t id)
+{
+    if (!self) return 0;
+    id_table_page_t* page = id_table_pri_getPage(self, id, SN_FALSE);
+    if (!page) return 0;
+
+    uint32_t* holders = &page->holders[id & (ID_TABLE_PAGE_SLOTS - 1)];
+    uint32_t count = plat_atomic_load_relaxed(holders);
+    while (count && !plat_atomic_cas(holders, &count, count - 1))
+    {
+    }
+    return count ? count - 1 : 0;
+}
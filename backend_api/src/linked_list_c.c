@@ -29,19 +29,13 @@
 
 #include "platform_independent/plat_threading.h"
 #include "platform_independent/plat_allocators.h"
+#include "platform_independent/plat_atomic.h"
+#include "stats_c.h"
 
 #pragma region "linked_list_entry_c code"
 
-linked_list_entry_c linked_list_entry_new(linked_list_entry_c previous, void* data, size_t size, sn_tid_t tid)
+static linked_list_entry_c linked_list_entry_pri_init(linked_list_entry_c self, linked_list_entry_c previous, void* data, size_t size, sn_tid_t tid)
 {
-    linked_list_entry_c self = plat_malloc(sizeof(linked_list_entry_t));
-
-    if (self == NULL)
-    {
-        return NULL;
-    }
-
-    memset(self, 0, sizeof(linked_list_entry_t));
 
     //If previous is null leave it for manual linking
     if (previous != NULL)
@@ -58,11 +52,37 @@ linked_list_entry_c linked_list_entry_new(linked_list_entry_c previous, void* da
     self->data = data;
     self->size = size;
     self->tid = tid;
-    self->mutex = NULL;
+    self->rwlock = NULL;
 
     return self;
 }
 
+linked_list_entry_c linked_list_entry_new(linked_list_entry_c previous, void* data, size_t size, sn_tid_t tid)
+{
+    linked_list_entry_c self = plat_malloc(sizeof(linked_list_entry_t));
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    memset(self, 0, sizeof(linked_list_entry_t));
+    return linked_list_entry_pri_init(self, previous, data, size, tid);
+}
+
+linked_list_entry_c linked_list_entry_newFromPool(node_pool_c pool, linked_list_entry_c previous, void* data, size_t size, sn_tid_t tid)
+{
+    linked_list_entry_c self = node_pool_alloc(pool); // Comes back zeroed
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    self->pool = pool;
+    return linked_list_entry_pri_init(self, previous, data, size, tid);
+}
+
 linked_list_entry_c linked_list_entry_getPreviousEntry(const linked_list_entry_c self)
 {
     if (self == NULL) return NULL;
@@ -72,9 +92,9 @@ linked_list_entry_c linked_list_entry_getPreviousEntry(const linked_list_entry_c
 void linked_list_entry_setPreviousEntry(linked_list_entry_c self, linked_list_entry_c new_previous)
 {
     if (self == NULL) return;
-    plat_mutex_lock(self->mutex);
+    plat_rwlock_writeLock(self->rwlock);
     self->previous = new_previous;
-    plat_mutex_unlock(self->mutex);
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 void* linked_list_entry_getData(const linked_list_entry_c self)
@@ -86,9 +106,9 @@ void* linked_list_entry_getData(const linked_list_entry_c self)
 void linked_list_entry_setData(linked_list_entry_c self, void* new_data)
 {
     if (self == NULL) return;
-    plat_mutex_lock(self->mutex);
+    plat_rwlock_writeLock(self->rwlock);
     self->data = new_data;
-    plat_mutex_unlock(self->mutex);
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 size_t linked_list_entry_getSize(const linked_list_entry_c self)
@@ -101,9 +121,9 @@ size_t linked_list_entry_getSize(const linked_list_entry_c self)
 void linked_list_entry_setSize(linked_list_entry_c self, size_t new_size)
 {
     if (self == NULL) return;
-    plat_mutex_lock(self->mutex);
+    plat_rwlock_writeLock(self->rwlock);
     self->size = new_size;
-    plat_mutex_unlock(self->mutex);
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 uint64_t linked_list_entry_getTid(const linked_list_entry_c self)
@@ -115,9 +135,9 @@ uint64_t linked_list_entry_getTid(const linked_list_entry_c self)
 void linked_list_entry_setTid(linked_list_entry_c self, uint64_t new_tid)
 {
     if (self == NULL) return;
-    plat_mutex_lock(self->mutex);
+    plat_rwlock_writeLock(self->rwlock);
     self->tid = new_tid;
-    plat_mutex_unlock(self->mutex);
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 uint16_t linked_list_entry_getBlockId(const linked_list_entry_c self)
@@ -129,9 +149,9 @@ uint16_t linked_list_entry_getBlockId(const linked_list_entry_c self)
 void linked_list_entry_setBlockId(linked_list_entry_c self, uint16_t new_id)
 {
     if (self == NULL) return;
-    plat_mutex_lock(self->mutex);
+    plat_rwlock_writeLock(self->rwlock);
     self->block_id = new_id;
-    plat_mutex_unlock(self->mutex);
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 linked_list_entry_c linked_list_entry_getNextEntry(const linked_list_entry_c self)
@@ -143,9 +163,9 @@ linked_list_entry_c linked_list_entry_getNextEntry(const linked_list_entry_c sel
 void linked_list_entry_setNextEntry(linked_list_entry_c self, linked_list_entry_c new_next)
 {
     if (self == NULL) return;
-    plat_mutex_lock(self->mutex);
+    plat_rwlock_writeLock(self->rwlock);
     self->next = new_next;
-    plat_mutex_unlock(self->mutex);
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 uint8_t linked_list_entry_pri_getWeight(linked_list_entry_c self)
@@ -156,15 +176,19 @@ uint8_t linked_list_entry_pri_getWeight(linked_list_entry_c self)
 void linked_list_entry_pri_setWeight(linked_list_entry_c self, uint8_t weight)
 {
     if (self == NULL) return;
-    plat_mutex_lock(self->mutex);
+    plat_rwlock_writeLock(self->rwlock);
     self->_weight = weight;
-    plat_mutex_unlock(self->mutex);
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 void linked_list_entry_destroy(linked_list_entry_c self)
 {
     if (self == NULL) return;
-    plat_free(self);
+    // Always back to the pool it came from, the entry may have moved lists since
+    if (self->pool)
+        node_pool_free(self->pool, self);
+    else
+        plat_free(self);
 }
 
 static SN_BOOL linked_list_entry_pri_isHead(linked_list_entry_c self)
@@ -187,13 +211,11 @@ static void linked_list_entry_pri_reweave(linked_list_entry_c entry)
     entry->previous = NULL;
 }
 
+// Lookups only hold the read lock, two of them racing can lose a bump which is fine for a heat estimate
 static void linked_list_entry_pri_weight_increase(linked_list_entry_c self)
 {
-    plat_mutex_lock(self->mutex);
-    uint8_t* cwei = &self->_weight;
-
-    if (*cwei <= UINT8_MAX) (*cwei)++;
-    plat_mutex_unlock(self->mutex);
+    const uint8_t weight = plat_atomic_load_relaxed(&self->_weight);
+    if (weight < UINT8_MAX) plat_atomic_store_relaxed(&self->_weight, (uint8_t)(weight + 1)); // Saturates, a hot block must not wrap back to cold
 }
 
 #pragma endregion
@@ -211,9 +233,16 @@ linked_list_c linked_list_new()
     }
     memset(self, 0, sizeof(linked_list_t));
 
+    self->pool = node_pool_new(sizeof(linked_list_entry_t), LINKED_LIST_NODES_PER_PAGE);
+
+    if (self->pool == NULL)
+    {
+        sn_crash(SN_ERR_CATASTROPHIC);
+    }
+
     //heads of lists are dummies They should be treated as Slightly immutable
 
-    self->head = linked_list_entry_new(NULL, NULL, 0, plat_getTid());
+    self->head = linked_list_entry_newFromPool(self->pool, NULL, NULL, 0, plat_getTid());
 
     if (self->head == NULL)
     {
@@ -223,14 +252,23 @@ linked_list_c linked_list_new()
     self->head->isHead = SN_TRUE;
     self->lastEntry = self->head;
     self->firstEntry = self->head;
-    self->mutex = plat_mutex_new();
+    self->index = ptr_index_new(PTR_INDEX_MIN_CAPACITY);
+
+    if (self->index == NULL)
+    {
+        sn_crash(SN_ERR_CATASTROPHIC);
+    }
+
+    self->rwlock = plat_rwlock_new();
 
     return self;
 }
 
 static linked_list_entry_c pri_listDestroyer(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
 {
-    linked_list_entry_destroy(ctx);
+    // Pooled nodes go when their pool does, possibly a different list's if they were moved here
+    if (!ctx->pool)
+        linked_list_entry_destroy(ctx);
     return NULL;
 }
 
@@ -239,34 +277,103 @@ void linked_list_destroy(linked_list_c self)
     if (self == NULL) return;
 
     linked_list_forEach(self, pri_listDestroyer, NULL);
-    linked_list_entry_destroy(self->head);
-    plat_mutex_destroy(self->mutex);
+    ptr_index_destroy(self->index);
+    node_pool_destroy(self->pool);
+    plat_rwlock_destroy(self->rwlock);
     plat_free(self);
 }
 
-void linked_list_push(linked_list_c self, void* data, size_t size, uint64_t tid)
+/*
+ * sn_register lets the same address in more than once, the index keeps one entry per key (the oldest)
+ * and the address tree holds every one of them, so the next in line is found there when the indexed one leaves
+ * Both expect the caller to hold the list write lock
+ */
+static void linked_list_pri_indexAdd(linked_list_c self, linked_list_entry_c entry)
 {
-    if (!self) return;
-    if (self->firstEntry == NULL) sn_crash(SN_ERR_CATASTROPHIC);
-    plat_mutex_lock(self->mutex);
-    linked_list_entry_c new_entry = linked_list_entry_new(self->lastEntry, data, size, tid);
+    addr_tree_insert(&self->addr_tree, entry);
 
-    if (new_entry == NULL)
+    // NULL keys can't be indexed, sn_register lets those through
+    if (entry->data == NULL || ptr_index_get(self->index, entry->data)) return;
+    if (!ptr_index_put(self->index, entry->data, entry))
+    {
+        sn_crash(SN_ERR_CATASTROPHIC);
+    }
+}
+
+static void linked_list_pri_indexDrop(linked_list_c self, linked_list_entry_c entry)
+{
+    addr_tree_remove(&self->addr_tree, entry);
+
+    if (entry->data == NULL || ptr_index_get(self->index, entry->data) != entry) return;
+    ptr_index_remove(self->index, entry->data);
+
+    linked_list_entry_c twin = addr_tree_floor(&self->addr_tree, entry->data);
+    if (twin && twin->data == entry->data && !ptr_index_put(self->index, twin->data, twin))
     {
         sn_crash(SN_ERR_CATASTROPHIC);
     }
+}
 
-    new_entry->mutex = self->mutex;
+// Caller must hold the list write lock
+static void linked_list_pri_link(linked_list_c self, linked_list_entry_c entry)
+{
+    entry->previous = self->lastEntry;
+    entry->next = NULL;
+    self->lastEntry->next = entry;
+    entry->rwlock = self->rwlock;
+
+    linked_list_pri_indexAdd(self, entry);
 
     if (linked_list_entry_pri_isHead(self->firstEntry))
     {
-        self->firstEntry = new_entry;
+        self->firstEntry = entry;
     }
 
-    self->lastEntry = new_entry;
+    self->lastEntry = entry;
 
     self->len++;
-    plat_mutex_unlock(self->mutex);
+    self->bytes += entry->size;
+}
+
+linked_list_entry_c linked_list_push(linked_list_c self, void* data, size_t size, uint64_t tid)
+{
+    if (!self) return NULL;
+    if (self->firstEntry == NULL) sn_crash(SN_ERR_CATASTROPHIC);
+    linked_list_entry_c new_entry = linked_list_entry_newFromPool(self->pool, NULL, data, size, tid);
+
+    if (new_entry == NULL)
+    {
+        sn_crash(SN_ERR_CATASTROPHIC);
+    }
+
+    plat_rwlock_writeLock(self->rwlock);
+    linked_list_pri_link(self, new_entry);
+    plat_rwlock_writeUnlock(self->rwlock);
+    return new_entry;
+}
+
+void linked_list_pushBatch(linked_list_c self, void* const* data, const size_t* sizes, size_t count, sn_tid_t tid, linked_list_entry_c* out)
+{
+    if (!self || !count) return;
+    if (self->firstEntry == NULL) sn_crash(SN_ERR_CATASTROPHIC);
+
+    if (!node_pool_allocBatch(self->pool, (void**)out, count))
+    {
+        sn_crash(SN_ERR_CATASTROPHIC);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i]->pool = self->pool;
+        linked_list_entry_pri_init(out[i], NULL, data[i], sizes[i], tid);
+    }
+
+    plat_rwlock_writeLock(self->rwlock);
+    for (size_t i = 0; i < count; i++)
+    {
+        linked_list_pri_link(self, out[i]);
+    }
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 linked_list_entry_c linked_list_peek(linked_list_c self)
@@ -274,25 +381,40 @@ linked_list_entry_c linked_list_peek(linked_list_c self)
     return self->lastEntry;
 }
 
-void linked_list_pop(linked_list_c self)
+// Caller must hold the list write lock
+static void linked_list_pri_unlink(linked_list_c self, linked_list_entry_c entry)
 {
-    plat_mutex_lock(self->mutex);
-    if (linked_list_entry_pri_isHead(self->lastEntry)) return;
+    linked_list_pri_indexDrop(self, entry);
 
-    linked_list_entry_c temp = self->lastEntry;
-    self->lastEntry = temp->previous;
-    self->lastEntry->next = NULL;
+    if (self->lastAccess == entry)
+        self->lastAccess = NULL;
 
-    linked_list_entry_destroy(temp);
-
-    if (linked_list_entry_pri_isHead(self->lastEntry)) //Just in case we popped so far back
+    if (self->lastEntry == entry)
+    {
+        self->lastEntry = entry->previous;
+        if (linked_list_entry_pri_isHead(self->lastEntry)) //Just in case we popped so far back
+            self->firstEntry = self->lastEntry;
+    }
+    else if (self->firstEntry == entry)
     {
-        self->firstEntry = self->lastEntry;
+        self->firstEntry = entry->next;
     }
 
+    linked_list_entry_pri_reweave(entry);
     self->len--;
+    self->bytes -= entry->size;
+}
 
-    plat_mutex_unlock(self->mutex);
+void linked_list_pop(linked_list_c self)
+{
+    plat_rwlock_writeLock(self->rwlock);
+    if (!linked_list_entry_pri_isHead(self->lastEntry))
+    {
+        linked_list_entry_c entry = self->lastEntry;
+        linked_list_pri_unlink(self, entry);
+        linked_list_entry_destroy(entry);
+    }
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 size_t linked_list_getSize(linked_list_c self)
@@ -304,10 +426,13 @@ linked_list_entry_c linked_list_forEach(linked_list_c self, linked_list_for_each
 {
     if (self == NULL || worker == NULL) return NULL;
     if (self->len == 0) return NULL;
+    plat_rwlock_readLock(self->rwlock);
     linked_list_entry_c entry = self->firstEntry;
-    plat_mutex_lock(self->mutex);
     if (linked_list_entry_pri_isHead(entry))
+    {
+        plat_rwlock_readUnlock(self->rwlock);
         return NULL;
+    }
 
     size_t i = 0;
 
@@ -315,41 +440,31 @@ linked_list_entry_c linked_list_forEach(linked_list_c self, linked_list_for_each
     {
         linked_list_entry_c next = entry->next;
         linked_list_entry_c temp = worker(self, entry, i++, generic_arg);
-        plat_mutex_lock(self->mutex); // Just in case the worker uses anything that unlocks the mutex
         if (temp != NULL)
         {
-            plat_mutex_unlock(self->mutex);
+            plat_rwlock_readUnlock(self->rwlock);
             if (temp == LIST_FOR_EACH_LOOP_BRAKE)
                 return NULL; //Produce a sanitary value on loop break
             return temp;
         }
         entry = next;
     }
-    plat_mutex_unlock(self->mutex);
-    return NULL;
-}
-
-static linked_list_entry_c linked_list_searchForPointer(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
-{
-    if (linked_list_entry_getData(ctx) == generic_arg)
-    {
-        return ctx;
-    }
+    plat_rwlock_readUnlock(self->rwlock);
     return NULL;
 }
 
 SN_BOOL linked_list_hasPtr(linked_list_c self, void* key)
 {
     if (!self || !key) return SN_FALSE;
-    plat_mutex_lock(self->mutex);
-    linked_list_entry_c temp = linked_list_forEach(self, &linked_list_searchForPointer, key);
+    plat_rwlock_readLock(self->rwlock);
+    linked_list_entry_c temp = ptr_index_get(self->index, key);
     if (temp != NULL)
     {
-        self->lastAccess = temp;
-        plat_mutex_unlock(self->mutex);
+        plat_atomic_store_relaxed(&self->lastAccess, temp);
+        plat_rwlock_readUnlock(self->rwlock);
         return SN_TRUE;
     }
-    plat_mutex_unlock(self->mutex);
+    plat_rwlock_readUnlock(self->rwlock);
     return SN_FALSE;
 }
 
@@ -368,20 +483,21 @@ linked_list_entry_c linked_list_getByPtr(linked_list_c self, void* key)
 {
     if (!self || !key) return NULL;
 
-    linked_list_entry_c temp = linked_list_forEach(self, &linked_list_searchForPointer, key);
+    plat_rwlock_readLock(self->rwlock);
+    linked_list_entry_c temp = ptr_index_get(self->index, key);
     if (temp)
     {
-        self->lastAccess = temp;
-        plat_mutex_lock(self->mutex);
-        temp->_weight++;
-        plat_mutex_unlock(self->mutex);
+        plat_atomic_store_relaxed(&self->lastAccess, temp);
+        linked_list_entry_pri_weight_increase(temp);
     }
+    plat_rwlock_readUnlock(self->rwlock);
     return temp;
 }
 
 static linked_list_entry_c linked_list_searchForIndex(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
 {
     if (!generic_arg) return NULL;
+    stats_inc(STATS_SCAN_STEP);
     if (index == *((const size_t*)generic_arg))
     {
         return ctx;
@@ -394,13 +510,12 @@ linked_list_entry_c linked_list_getByIndex(linked_list_c self, size_t index)
     if (!self) return NULL;
     if (linked_list_getSize(self) < index) return NULL;
 
+    stats_inc(STATS_LOOKUP_SCAN);
     linked_list_entry_c temp = linked_list_forEach(self, &linked_list_searchForIndex, &index);
     if (temp)
     {
-        self->lastAccess = temp;
-        plat_mutex_lock(self->mutex);
-        temp->_weight++;
-        plat_mutex_unlock(self->mutex);
+        plat_atomic_store_relaxed(&self->lastAccess, temp);
+        linked_list_entry_pri_weight_increase(temp);
     }
 
     return temp;
@@ -409,6 +524,7 @@ linked_list_entry_c linked_list_getByIndex(linked_list_c self, size_t index)
 static linked_list_entry_c linked_list_searchForId(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
 {
     if (!generic_arg) return NULL;
+    stats_inc(STATS_SCAN_STEP);
     if (linked_list_entry_getBlockId(ctx) == *((const uint16_t*)generic_arg))
     {
         return ctx;
@@ -419,60 +535,125 @@ static linked_list_entry_c linked_list_searchForId(linked_list_c self, linked_li
 linked_list_entry_c linked_list_getById(linked_list_c self, uint16_t id)
 {
     if (!self) return NULL;
-    plat_mutex_lock(self->mutex);
     linked_list_entry_c temp = linked_list_forEach(self, &linked_list_searchForId, (uint16_t*)&id);
     if (temp)
     {
-        self->lastAccess = temp;
-        plat_mutex_lock(self->mutex);
-        temp->_weight++;
-        plat_mutex_unlock(self->mutex);
+        plat_atomic_store_relaxed(&self->lastAccess, temp);
+        linked_list_entry_pri_weight_increase(temp);
     }
     return temp;
 }
 
 
+linked_list_entry_c linked_list_getContaining(linked_list_c self, const void* addr)
+{
+    if (!self || !addr) return NULL;
+
+    plat_rwlock_readLock(self->rwlock);
+    linked_list_entry_c temp = addr_tree_floor(&self->addr_tree, addr);
+    // Zero sized (sn_register) blocks only contain their own start
+    if (temp && (uintptr_t)addr - (uintptr_t)temp->data >= (temp->size ? temp->size : 1))
+        temp = NULL;
+    plat_rwlock_readUnlock(self->rwlock);
+    return temp;
+}
+
 void linked_list_removeEntryByPtr(linked_list_c self, void* key)
 {
     if (!self || !key) return;
 
-    plat_mutex_lock(self->mutex);
-    linked_list_entry_c entry = linked_list_forEach(self, linked_list_searchForPointer, key);
+    plat_rwlock_writeLock(self->rwlock);
+    linked_list_entry_c entry = ptr_index_get(self->index, key);
 
-    linked_list_removeEntry(self, entry);
+    if (entry)
+    {
+        linked_list_pri_unlink(self, entry);
+        linked_list_entry_destroy(entry);
+    }
 
-    plat_mutex_unlock(self->mutex);
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 SN_BOOL linked_list_removeEntry(linked_list_c self, linked_list_entry_c entry_ref)
 {
     if (!self) return SN_FALSE;
     if (!entry_ref) return  SN_FALSE;
-    plat_mutex_lock(self->mutex);
+    if (linked_list_entry_pri_isHead(entry_ref)) return SN_FALSE;
 
+    plat_rwlock_writeLock(self->rwlock);
+    linked_list_pri_unlink(self, entry_ref);
+    plat_rwlock_writeUnlock(self->rwlock);
+    linked_list_entry_destroy(entry_ref);
+    return SN_TRUE;
+}
+
+void linked_list_removeBatch(linked_list_c self, linked_list_entry_c* entries, size_t count)
+{
+    if (!self || !entries || !count) return;
 
-    if (self->lastEntry == entry_ref)
+    plat_rwlock_writeLock(self->rwlock);
+    for (size_t i = 0; i < count; i++)
     {
-        plat_mutex_unlock(self->mutex);
-        linked_list_pop(self);
-        return SN_TRUE;
+        if (entries[i] && !linked_list_entry_pri_isHead(entries[i]))
+            linked_list_pri_unlink(self, entries[i]);
     }
+    plat_rwlock_writeUnlock(self->rwlock);
 
-    linked_list_entry_c pre = entry_ref->previous;
-    linked_list_entry_c nxt = entry_ref->next;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (entries[i] && !linked_list_entry_pri_isHead(entries[i]))
+            linked_list_entry_destroy(entries[i]);
+    }
+}
 
-    if (pre)
-        pre->next = nxt;
-    if(nxt)
-        nxt->previous = pre;
+SN_BOOL linked_list_detachEntry(linked_list_c self, linked_list_entry_c entry_ref)
+{
+    if (!self || !entry_ref) return SN_FALSE;
+    if (linked_list_entry_pri_isHead(entry_ref)) return SN_FALSE;
 
-    linked_list_entry_destroy(entry_ref);
+    plat_rwlock_writeLock(self->rwlock);
+    linked_list_pri_unlink(self, entry_ref);
+    entry_ref->rwlock = NULL;
+    plat_rwlock_writeUnlock(self->rwlock);
+    return SN_TRUE;
+}
+
+void linked_list_attachEntry(linked_list_c self, linked_list_entry_c entry_ref, void* data)
+{
+    if (!self || !entry_ref) return;
 
-    if (self->firstEntry == entry_ref)
-        self->firstEntry = nxt;
+    plat_rwlock_writeLock(self->rwlock);
+    plat_atomic_store(&entry_ref->data, data); // Lookup caches may still be checking the old key against it
+    linked_list_pri_link(self, entry_ref);
+    plat_rwlock_writeUnlock(self->rwlock);
+}
 
-    plat_mutex_unlock(self->mutex);
-    return SN_TRUE;
+void linked_list_resizeEntry(linked_list_c self, linked_list_entry_c entry_ref, size_t new_size)
+{
+    if (!self || !entry_ref) return;
+
+    plat_rwlock_writeLock(self->rwlock);
+    self->bytes -= entry_ref->size;
+    self->bytes += new_size;
+    entry_ref->size = new_size;
+    plat_rwlock_writeUnlock(self->rwlock);
+}
+
+size_t linked_list_getBytes(linked_list_c self)
+{
+    if (!self) return 0;
+    return self->bytes;
+}
+
+void linked_list_rekeyEntry(linked_list_c self, linked_list_entry_c entry_ref, void* new_data)
+{
+    if (!self || !entry_ref) return;
+
+    plat_rwlock_writeLock(self->rwlock);
+    linked_list_pri_indexDrop(self, entry_ref);
+    plat_atomic_store(&entry_ref->data, new_data);
+    linked_list_pri_indexAdd(self, entry_ref);
+    plat_rwlock_writeUnlock(self->rwlock);
 }
 
 
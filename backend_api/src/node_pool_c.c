@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#include "node_pool_c.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "libsafetynet.h"
+#include "platform_independent/plat_allocators.h"
+
+#define NODE_POOL_ALIGNMENT (sizeof(void*) * 2)
+#define node_pool_pri_roundUp(x) (((x) + NODE_POOL_ALIGNMENT - 1) & ~(NODE_POOL_ALIGNMENT - 1))
+
+// Objects start after the page link, rounded so they keep malloc's alignment
+#define NODE_POOL_PAGE_HEADER_SIZE node_pool_pri_roundUp(sizeof(node_pool_page_t))
+
+node_pool_c node_pool_new(size_t object_size, size_t objects_per_page)
+{
+    if (!object_size || !objects_per_page) return NULL;
+
+    node_pool_c self = plat_malloc(sizeof(node_pool_t));
+    if (!self) return NULL;
+    memset(self, 0, sizeof(node_pool_t));
+
+    self->object_size = node_pool_pri_roundUp(object_size < sizeof(void*) ? sizeof(void*) : object_size);
+    self->objects_per_page = objects_per_page;
+    self->mutex = plat_mutex_new();
+
+    if (!self->mutex)
+    {
+        plat_free(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void node_pool_destroy(node_pool_c self)
+{
+    if (!self) return;
+
+    node_pool_page_t* page = self->pages;
+    while (page)
+    {
+        node_pool_page_t* next = page->next;
+        plat_backend_free(page->backend, page);
+        page = next;
+    }
+
+    plat_mutex_destroy(self->mutex);
+    plat_free(self);
+}
+
+// Caller must hold the pool mutex
+static SN_BOOL node_pool_pri_grow(node_pool_c self)
+{
+    const uint8_t backend = plat_backend_current(PLAT_BACKEND_FOR_NODES);
+    node_pool_page_t* page = plat_backend_malloc(backend, NODE_POOL_PAGE_HEADER_SIZE + self->object_size * self->objects_per_page);
+    if (!page) return SN_FALSE;
+    page->backend = backend;
+
+    page->next = self->pages;
+    self->pages = page;
+    self->page_count++;
+
+    // Thread back to front so the free list hands the page out in address order
+    uint8_t* objects = (uint8_t*)page + NODE_POOL_PAGE_HEADER_SIZE;
+    for (size_t i = self->objects_per_page; i > 0; i--)
+    {
+        void** object = (void**)(objects + (i - 1) * self->object_size);
+        *object = self->free_list;
+        self->free_list = object;
+    }
+
+    return SN_TRUE;
+}
+
+void* node_pool_alloc(node_pool_c self)
+{
+    if (!self) return NULL;
+
+    plat_mutex_lock(self->mutex);
+    if (!self->free_list && !node_pool_pri_grow(self))
+    {
+        plat_mutex_unlock(self->mutex);
+        return NULL;
+    }
+
+    void** object = self->free_list;
+    self->free_list = *object;
+    self->live_count++;
+    plat_mutex_unlock(self->mutex);
+
+    memset(object, 0, self->object_size);
+    return object;
+}
+
+void node_pool_free(node_pool_c self, void* object)
+{
+    if (!self || !object) return;
+
+    plat_mutex_lock(self->mutex);
+    *(void**)object = self->free_list;
+    self->free_list = object;
+    self->live_count--;
+    plat_mutex_unlock(self->mutex);
+}
+
+SN_BOOL node_pool_allocBatch(node_pool_c self, void** out, size_t count)
+{
+    if (!self || !out) return SN_FALSE;
+
+    plat_mutex_lock(self->mutex);
+    size_t i = 0;
+    for (; i < count; i++)
+    {
+        if (!self->free_list && !node_pool_pri_grow(self))
+            break;
+
+        void** object = self->free_list;
+        self->free_list = *object;
+        out[i] = object;
+    }
+
+    if (i != count)
+    {
+        // Pages stay around anyway, just thread what we took back on
+        while (i > 0)
+        {
+            i--;
+            *(void**)out[i] = self->free_list;
+            self->free_list = out[i];
+        }
+        plat_mutex_unlock(self->mutex);
+        return SN_FALSE;
+    }
+
+    self->live_count += count;
+    plat_mutex_unlock(self->mutex);
+
+    for (i = 0; i < count; i++)
+    {
+        memset(out[i], 0, self->object_size);
+    }
+    return SN_TRUE;
+}
+
+size_t node_pool_getLiveCount(node_pool_c self)
+{
+    if (!self) return 0;
+    return self->live_count;
+}
+
+size_t node_pool_getPageCount(node_pool_c self)
+{
+    if (!self) return 0;
+    return self->page_count;
+}
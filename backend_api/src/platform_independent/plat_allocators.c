@@ -54,25 +54,332 @@
 //
 
 
+#ifndef _GNU_SOURCE
+#   define _GNU_SOURCE // mremap
+#endif
+
 #include <stdlib.h>
+#include <string.h>
+#include "libsafetynet_config.h"
 #include "platform_independent/plat_allocators.h"
+#include "platform_independent/plat_atomic.h"
+
+#if defined(__SSE2__)
+#   include <emmintrin.h>
+#endif
+
+#ifdef SN_ON_UNIX
+#   include <unistd.h>
+#   include <sys/mman.h>
+#   if defined(__GLIBC__)
+#       include <malloc.h>
+#       define PLAT_MALLOC_USABLE_SIZE(ptr) malloc_usable_size(ptr)
+#   elif defined(__APPLE__)
+#       include <malloc/malloc.h>
+#       define PLAT_MALLOC_USABLE_SIZE(ptr) malloc_size(ptr)
+#   endif
+#elif defined(SN_ON_WIN32)
+#   include <malloc.h>
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#   define PLAT_MALLOC_USABLE_SIZE(ptr) _msize(ptr)
+#endif
+
+// The LD_PRELOAD build is malloc, so it has to reach glibc's own entry points or every plat_malloc would come back through it
+#if defined(BUILDING_SAFETYNET_PRELOAD) && defined(__GLIBC__)
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t num, size_t size);
+extern void* __libc_realloc(void* ptr, size_t new_size);
+extern void __libc_free(void* ptr);
+extern void* __libc_memalign(size_t alignment, size_t size);
+#   define PLAT_LIBC_MALLOC __libc_malloc
+#   define PLAT_LIBC_CALLOC __libc_calloc
+#   define PLAT_LIBC_REALLOC __libc_realloc
+#   define PLAT_LIBC_FREE __libc_free
+#else
+#   define PLAT_LIBC_MALLOC malloc
+#   define PLAT_LIBC_CALLOC calloc
+#   define PLAT_LIBC_REALLOC realloc
+#   define PLAT_LIBC_FREE free
+#endif
 
 void* plat_malloc(size_t size)
 {
-    return malloc(size);
+    return PLAT_LIBC_MALLOC(size);
 }
 
 void* plat_realloc(void* ptr, size_t new_size)
 {
-    return realloc(ptr, new_size);
+    return PLAT_LIBC_REALLOC(ptr, new_size);
 }
 
 void* plat_calloc(size_t num, size_t size)
 {
-    return calloc(num, size);
+    return PLAT_LIBC_CALLOC(num, size);
 }
 
 void plat_free(void* ptr)
 {
-    free(ptr);
+    PLAT_LIBC_FREE(ptr);
+}
+
+void* plat_aligned_alloc(size_t alignment, size_t size)
+{
+    // posix_memalign wants at least pointer alignment, asking for less is just malloc anyway
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+#ifdef SN_ON_WIN32
+    return _aligned_malloc(size, alignment);
+#else
+#   if defined(BUILDING_SAFETYNET_PRELOAD) && defined(__GLIBC__)
+    return __libc_memalign(alignment, size);
+#   else
+    void* ptr = NULL;
+    if (posix_memalign(&ptr, alignment, size) != 0)
+        return NULL;
+    return ptr;
+#   endif
+#endif
+}
+
+void plat_aligned_free(void* ptr)
+{
+#ifdef SN_ON_WIN32
+    _aligned_free(ptr);
+#else
+    PLAT_LIBC_FREE(ptr);
+#endif
+}
+
+size_t plat_getPageSize()
+{
+    static size_t page_size = 0;
+    if (page_size) return page_size;
+
+#ifdef SN_ON_WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    page_size = info.dwPageSize;
+#else
+    const long queried = sysconf(_SC_PAGESIZE);
+    page_size = queried > 0 ? (size_t)queried : 4096;
+#endif
+    return page_size;
+}
+
+void* plat_map(size_t length)
+{
+#ifdef SN_ON_WIN32
+    return VirtualAlloc(NULL, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void* ptr = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return ptr == MAP_FAILED ? NULL : ptr;
+#endif
+}
+
+void plat_unmap(void* ptr, size_t length)
+{
+    if (!ptr) return;
+#ifdef SN_ON_WIN32
+    (void)length;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, length);
+#endif
+}
+
+void* plat_remap(void* ptr, size_t old_length, size_t new_length)
+{
+#if defined(SN_ON_UNIX) && defined(MREMAP_MAYMOVE)
+    void* moved = mremap(ptr, old_length, new_length, MREMAP_MAYMOVE);
+    return moved == MAP_FAILED ? NULL : moved;
+#else
+    void* moved = plat_map(new_length);
+    if (!moved) return NULL;
+
+    memcpy(moved, ptr, old_length < new_length ? old_length : new_length);
+    plat_unmap(ptr, old_length);
+    return moved;
+#endif
+}
+
+void plat_adviseHugePages(void* ptr, size_t length)
+{
+#if defined(SN_ON_UNIX) && defined(MADV_HUGEPAGE)
+    madvise(ptr, length, MADV_HUGEPAGE);
+#else
+    (void)ptr;
+    (void)length;
+#endif
+}
+
+// Below this a plain memset wins, the block is likely to be touched again soon anyway
+#define PLAT_CLEAR_STREAM_MIN ((size_t)256 * 1024)
+
+void plat_clear(void* ptr, size_t size)
+{
+#if defined(__SSE2__)
+    if (size >= PLAT_CLEAR_STREAM_MIN)
+    {
+        uint8_t* p = ptr;
+        const size_t head = (16 - ((uintptr_t)p & 15)) & 15;
+        memset(p, 0, head);
+        p += head;
+        size -= head;
+
+        const __m128i zero = _mm_setzero_si128();
+        uint8_t* const end = p + (size & ~(size_t)63);
+        for (; p < end; p += 64)
+        {
+            _mm_stream_si128((__m128i*)p, zero);
+            _mm_stream_si128((__m128i*)(p + 16), zero);
+            _mm_stream_si128((__m128i*)(p + 32), zero);
+            _mm_stream_si128((__m128i*)(p + 48), zero);
+        }
+        _mm_sfence(); // Streamed stores are weakly ordered, fence before the memory is freed or handed out
+
+        memset(p, 0, size & 63);
+        return;
+    }
+#endif
+    memset(ptr, 0, size);
+}
+
+void plat_discardPages(void* ptr, size_t size)
+{
+#if defined(SN_ON_UNIX) && defined(MADV_DONTNEED)
+    const uintptr_t page = plat_getPageSize();
+    const uintptr_t start = (uintptr_t)ptr;
+    const uintptr_t first = (start + page - 1) & ~(page - 1);
+    const uintptr_t last = (start + size) & ~(page - 1);
+
+    if (last > first && madvise((void*)first, last - first, MADV_DONTNEED) == 0)
+    {
+        plat_clear(ptr, first - start);
+        plat_clear((void*)last, start + size - last);
+        return;
+    }
+#endif
+    plat_clear(ptr, size);
+}
+
+static void* plat_backend_pri_libcMalloc(void* ctx, size_t size)
+{
+    (void)ctx;
+    return PLAT_LIBC_MALLOC(size);
+}
+
+static void* plat_backend_pri_libcCalloc(void* ctx, size_t num, size_t size)
+{
+    (void)ctx;
+    return PLAT_LIBC_CALLOC(num, size);
+}
+
+static void* plat_backend_pri_libcRealloc(void* ctx, void* ptr, size_t new_size)
+{
+    (void)ctx;
+    return PLAT_LIBC_REALLOC(ptr, new_size);
+}
+
+static void plat_backend_pri_libcFree(void* ctx, void* ptr)
+{
+    (void)ctx;
+    PLAT_LIBC_FREE(ptr);
+}
+
+static size_t plat_backend_pri_libcUsableSize(void* ctx, void* ptr)
+{
+    (void)ctx;
+#ifdef PLAT_MALLOC_USABLE_SIZE
+    return PLAT_MALLOC_USABLE_SIZE(ptr);
+#else
+    (void)ptr;
+    return 0;
+#endif
+}
+
+static sn_backend_ops_t plat_backends[PLAT_BACKEND_SLOTS] = {
+    [PLAT_BACKEND_LIBC] = {
+        .malloc_fn = plat_backend_pri_libcMalloc,
+        .calloc_fn = plat_backend_pri_libcCalloc,
+        .realloc_fn = plat_backend_pri_libcRealloc,
+        .free_fn = plat_backend_pri_libcFree,
+        .usable_size_fn = plat_backend_pri_libcUsableSize,
+        .ctx = NULL,
+    },
+};
+static size_t plat_backend_count = 1;
+static uint8_t plat_backend_in_use[PLAT_BACKEND_USE_COUNT] = {PLAT_BACKEND_LIBC, PLAT_BACKEND_LIBC};
+
+const sn_backend_ops_t* plat_backend_getLibc()
+{
+    return &plat_backends[PLAT_BACKEND_LIBC];
+}
+
+// Caller serializes installs (sn_set_*backend_allocator hold alloc_mutex)
+SN_BOOL plat_backend_install(plat_backend_use_e use, const sn_backend_ops_t* ops)
+{
+    if (use >= PLAT_BACKEND_USE_COUNT) return SN_FALSE;
+
+    size_t slot = 0;
+    if (ops)
+    {
+        // Reinstalling something we already have reuses its slot
+        for (slot = 0; slot < plat_backend_count; slot++)
+        {
+            if (memcmp(&plat_backends[slot], ops, sizeof(sn_backend_ops_t)) == 0) break;
+        }
+
+        if (slot == plat_backend_count)
+        {
+            if (plat_backend_count == PLAT_BACKEND_SLOTS) return SN_FALSE;
+            plat_backends[slot] = *ops;
+            plat_backend_count++;
+        }
+    }
+
+    // Release so a thread that sees the new slot also sees its ops
+    plat_atomic_store(&plat_backend_in_use[use], (uint8_t)slot);
+    return SN_TRUE;
+}
+
+uint8_t plat_backend_current(plat_backend_use_e use)
+{
+    return plat_atomic_load(&plat_backend_in_use[use]);
+}
+
+void* plat_backend_malloc(uint8_t slot, size_t size)
+{
+    const sn_backend_ops_t* ops = &plat_backends[slot];
+    return ops->malloc_fn(ops->ctx, size);
+}
+
+void* plat_backend_calloc(uint8_t slot, size_t num, size_t size)
+{
+    const sn_backend_ops_t* ops = &plat_backends[slot];
+    if (ops->calloc_fn) return ops->calloc_fn(ops->ctx, num, size);
+
+    // Overflow is checked by every caller
+    void* ptr = ops->malloc_fn(ops->ctx, num * size);
+    if (ptr) memset(ptr, 0, num * size);
+    return ptr;
+}
+
+void* plat_backend_realloc(uint8_t slot, void* ptr, size_t new_size)
+{
+    const sn_backend_ops_t* ops = &plat_backends[slot];
+    return ops->realloc_fn(ops->ctx, ptr, new_size);
+}
+
+void plat_backend_free(uint8_t slot, void* ptr)
+{
+    if (!ptr) return;
+    const sn_backend_ops_t* ops = &plat_backends[slot];
+    ops->free_fn(ops->ctx, ptr);
+}
+
+size_t plat_backend_usableSize(uint8_t slot, void* ptr)
+{
+    const sn_backend_ops_t* ops = &plat_backends[slot];
+    if (!ptr || !ops->usable_size_fn) return 0;
+    return ops->usable_size_fn(ops->ctx, ptr);
 }
@@ -53,6 +53,10 @@
 // Created by tete on 06/16/2025.
 //
 
+#ifndef _GNU_SOURCE
+#   define _GNU_SOURCE // pthread_rwlockattr_setkind_np
+#endif
+
 #include "platform_independent/plat_threading.h"
 
 #include <stdlib.h>
@@ -62,10 +66,12 @@
 #include <platform_independent/plat_allocators.h>
 
 #include "sn_crash.h"
+#include "stats_c.h"
 
 #ifdef SN_CONFIG_ENABLE_MUTEX
 #   ifdef SN_ON_UNIX
 #       include <pthread.h>
+#       include <time.h>
 #   elif defined(SN_ON_WIN32)
 #       include <windows.h>
 #   else
@@ -81,7 +87,6 @@ struct plat_mutex_s
 #   elif defined(SN_ON_WIN32)
     HANDLE plat_mutex;
 #   endif
-    uint64_t locker_tid;
 #else
     uint8_t pad; // This is here because C With an empty struct return's zero for sizeof
 #endif
@@ -100,12 +105,22 @@ plat_mutex_c plat_mutex_new()
     memset(self, 0, sizeof(plat_mutex_t));
 #ifdef SN_CONFIG_ENABLE_MUTEX
 #   ifdef SN_ON_UNIX
-    if (pthread_mutex_init(&self->plat_mutex, NULL) != 0)
+    pthread_mutexattr_t attr;
+    if (pthread_mutexattr_init(&attr) != 0)
+    {
+        plat_free(self);
+        return NULL;
+    }
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    const int failed = pthread_mutex_init(&self->plat_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+    if (failed)
     {
         plat_free(self);
         return NULL;
     }
 #   elif defined(SN_ON_WIN32)
+    // Win32 mutexes are recursive already
     self->plat_mutex = CreateMutexW(NULL, FALSE, NULL);
     if (!self->plat_mutex)
     {
@@ -122,14 +137,20 @@ void plat_mutex_lock(plat_mutex_c self)
 {
     if (!self) return;
 #ifdef SN_CONFIG_ENABLE_MUTEX
-    if (plat_getTid() == self->locker_tid) return;
-
 #   ifdef SN_ON_UNIX
-    pthread_mutex_lock(&self->plat_mutex);
+    if (pthread_mutex_trylock(&self->plat_mutex) != 0)
+    {
+        stats_inc(STATS_LOCK_CONTENDED);
+        pthread_mutex_lock(&self->plat_mutex);
+    }
 #   elif defined(SN_ON_WIN32)
-    WaitForSingleObject(self->plat_mutex, INFINITE);
+    if (WaitForSingleObject(self->plat_mutex, 0) == WAIT_TIMEOUT)
+    {
+        stats_inc(STATS_LOCK_CONTENDED);
+        WaitForSingleObject(self->plat_mutex, INFINITE);
+    }
 #   endif
-    self->locker_tid = plat_getTid();
+    stats_inc(STATS_LOCK_ACQUIRE);
 #endif
 }
 
@@ -142,7 +163,6 @@ void plat_mutex_unlock(plat_mutex_c self)
 #   elif defined(SN_ON_WIN32)
     ReleaseMutex(self->plat_mutex);
 #   endif
-    self->locker_tid = 0;
 #endif
 }
 
@@ -161,6 +181,130 @@ void plat_mutex_destroy(plat_mutex_c self)
     plat_free(self);
 }
 
+struct plat_rwlock_s
+{
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_rwlock_t plat_rwlock;
+#   elif defined(SN_ON_WIN32)
+    SRWLOCK plat_rwlock;
+#   endif
+#else
+    uint8_t pad;
+#endif
+};
+
+plat_rwlock_c plat_rwlock_new()
+{
+    plat_rwlock_c self = plat_malloc(sizeof(plat_rwlock_t));
+    if (!self)
+    {
+        return NULL;
+    }
+
+    memset(self, 0, sizeof(plat_rwlock_t));
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_rwlockattr_t attr;
+    if (pthread_rwlockattr_init(&attr) != 0)
+    {
+        plat_free(self);
+        return NULL;
+    }
+#       ifdef __GLIBC__
+    // glibc prefers readers by default, a steady stream of queries would starve every malloc and free behind them
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#       endif
+    const int failed = pthread_rwlock_init(&self->plat_rwlock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    if (failed)
+    {
+        plat_free(self);
+        return NULL;
+    }
+#   elif defined(SN_ON_WIN32)
+    InitializeSRWLock(&self->plat_rwlock);
+#   endif
+#endif
+
+    return self;
+}
+
+void plat_rwlock_destroy(plat_rwlock_c self)
+{
+    if (!self) return;
+#if defined(SN_CONFIG_ENABLE_MUTEX) && defined(SN_ON_UNIX)
+    pthread_rwlock_destroy(&self->plat_rwlock);
+#endif
+    plat_free(self); // An SRWLOCK owns nothing
+}
+
+void plat_rwlock_readLock(plat_rwlock_c self)
+{
+    if (!self) return;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    if (pthread_rwlock_tryrdlock(&self->plat_rwlock) != 0)
+    {
+        stats_inc(STATS_LOCK_CONTENDED);
+        pthread_rwlock_rdlock(&self->plat_rwlock);
+    }
+#   elif defined(SN_ON_WIN32)
+    if (!TryAcquireSRWLockShared(&self->plat_rwlock))
+    {
+        stats_inc(STATS_LOCK_CONTENDED);
+        AcquireSRWLockShared(&self->plat_rwlock);
+    }
+#   endif
+    stats_inc(STATS_LOCK_ACQUIRE);
+#endif
+}
+
+void plat_rwlock_readUnlock(plat_rwlock_c self)
+{
+    if (!self) return;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_rwlock_unlock(&self->plat_rwlock);
+#   elif defined(SN_ON_WIN32)
+    ReleaseSRWLockShared(&self->plat_rwlock);
+#   endif
+#endif
+}
+
+void plat_rwlock_writeLock(plat_rwlock_c self)
+{
+    if (!self) return;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    if (pthread_rwlock_trywrlock(&self->plat_rwlock) != 0)
+    {
+        stats_inc(STATS_LOCK_CONTENDED);
+        pthread_rwlock_wrlock(&self->plat_rwlock);
+    }
+#   elif defined(SN_ON_WIN32)
+    if (!TryAcquireSRWLockExclusive(&self->plat_rwlock))
+    {
+        stats_inc(STATS_LOCK_CONTENDED);
+        AcquireSRWLockExclusive(&self->plat_rwlock);
+    }
+#   endif
+    stats_inc(STATS_LOCK_ACQUIRE);
+#endif
+}
+
+void plat_rwlock_writeUnlock(plat_rwlock_c self)
+{
+    if (!self) return;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_rwlock_unlock(&self->plat_rwlock);
+#   elif defined(SN_ON_WIN32)
+    ReleaseSRWLockExclusive(&self->plat_rwlock);
+#   endif
+#endif
+}
+
 uint64_t plat_getTid()
 {
 #ifdef SN_CONFIG_ENABLE_MUTEX
@@ -173,3 +317,291 @@ uint64_t plat_getTid()
     return 0;
 #endif
 }
+
+struct plat_tls_key_s
+{
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_key_t plat_key;
+#   elif defined(SN_ON_WIN32)
+    DWORD plat_key;
+#   endif
+#else
+    void* value; // No threads, no destructors
+#endif
+};
+
+plat_tls_key_c plat_tls_key_new(plat_tls_destructor_f destructor)
+{
+    plat_tls_key_c self = plat_malloc(sizeof(plat_tls_key_t));
+
+    if (!self)
+    {
+        return NULL;
+    }
+
+    memset(self, 0, sizeof(plat_tls_key_t));
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    if (pthread_key_create(&self->plat_key, destructor) != 0)
+    {
+        plat_free(self);
+        return NULL;
+    }
+#   elif defined(SN_ON_WIN32)
+    // Fiber local storage is the only flavour on windows that calls back on thread exit
+    self->plat_key = FlsAlloc((PFLS_CALLBACK_FUNCTION)destructor);
+    if (self->plat_key == FLS_OUT_OF_INDEXES)
+    {
+        plat_free(self);
+        return NULL;
+    }
+#   endif
+#else
+    (void)destructor;
+#endif
+
+    return self;
+}
+
+void plat_tls_key_destroy(plat_tls_key_c self)
+{
+    if (!self) return;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_key_delete(self->plat_key);
+#   elif defined(SN_ON_WIN32)
+    FlsFree(self->plat_key);
+#   endif
+#endif
+    plat_free(self);
+}
+
+void plat_tls_set(plat_tls_key_c self, void* value)
+{
+    if (!self) return;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_setspecific(self->plat_key, value);
+#   elif defined(SN_ON_WIN32)
+    FlsSetValue(self->plat_key, value);
+#   endif
+#else
+    self->value = value;
+#endif
+}
+
+void* plat_tls_get(plat_tls_key_c self)
+{
+    if (!self) return NULL;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    return pthread_getspecific(self->plat_key);
+#   elif defined(SN_ON_WIN32)
+    return FlsGetValue(self->plat_key);
+#   endif
+#else
+    return self->value;
+#endif
+}
+
+struct plat_thread_s
+{
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_t plat_thread;
+#   elif defined(SN_ON_WIN32)
+    HANDLE plat_thread;
+#   endif
+#endif
+    plat_thread_f func;
+    void* arg;
+};
+
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+static void* plat_pri_threadEntry(void* arg)
+{
+    plat_thread_c self = arg;
+    self->func(self->arg);
+    return NULL;
+}
+#   elif defined(SN_ON_WIN32)
+static DWORD WINAPI plat_pri_threadEntry(LPVOID arg)
+{
+    plat_thread_c self = arg;
+    self->func(self->arg);
+    return 0;
+}
+#   endif
+#endif
+
+plat_thread_c plat_thread_new(plat_thread_f func, void* arg)
+{
+#ifdef SN_CONFIG_ENABLE_MUTEX
+    if (!func) return NULL;
+    plat_thread_c self = plat_malloc(sizeof(plat_thread_t));
+
+    if (!self)
+    {
+        return NULL;
+    }
+
+    memset(self, 0, sizeof(plat_thread_t));
+    self->func = func;
+    self->arg = arg;
+#   ifdef SN_ON_UNIX
+    if (pthread_create(&self->plat_thread, NULL, &plat_pri_threadEntry, self) != 0)
+    {
+        plat_free(self);
+        return NULL;
+    }
+#   elif defined(SN_ON_WIN32)
+    self->plat_thread = CreateThread(NULL, 0, &plat_pri_threadEntry, self, 0, NULL);
+    if (!self->plat_thread)
+    {
+        plat_free(self);
+        return NULL;
+    }
+#   endif
+    return self;
+#else
+    (void)func;
+    (void)arg;
+    return NULL;
+#endif
+}
+
+void plat_thread_join(plat_thread_c self)
+{
+    if (!self) return;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_join(self->plat_thread, NULL);
+#   elif defined(SN_ON_WIN32)
+    WaitForSingleObject(self->plat_thread, INFINITE);
+    CloseHandle(self->plat_thread);
+#   endif
+#endif
+    plat_free(self);
+}
+
+struct plat_event_s
+{
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_mutex_t plat_mutex;
+    pthread_cond_t plat_cond;
+    int signalled;
+#   elif defined(SN_ON_WIN32)
+    HANDLE plat_event;
+#   endif
+#else
+    uint8_t pad; // Nothing can signal a thread that does not exist
+#endif
+};
+
+plat_event_c plat_event_new()
+{
+    plat_event_c self = plat_malloc(sizeof(plat_event_t));
+
+    if (!self)
+    {
+        return NULL;
+    }
+
+    memset(self, 0, sizeof(plat_event_t));
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC); // Timeouts must not jump with the wall clock
+    if (pthread_mutex_init(&self->plat_mutex, NULL) != 0)
+    {
+        pthread_condattr_destroy(&attr);
+        plat_free(self);
+        return NULL;
+    }
+    if (pthread_cond_init(&self->plat_cond, &attr) != 0)
+    {
+        pthread_condattr_destroy(&attr);
+        pthread_mutex_destroy(&self->plat_mutex);
+        plat_free(self);
+        return NULL;
+    }
+    pthread_condattr_destroy(&attr);
+#   elif defined(SN_ON_WIN32)
+    self->plat_event = CreateEventW(NULL, FALSE, FALSE, NULL);
+    if (!self->plat_event)
+    {
+        plat_free(self);
+        return NULL;
+    }
+#   endif
+#endif
+
+    return self;
+}
+
+void plat_event_destroy(plat_event_c self)
+{
+    if (!self) return;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_cond_destroy(&self->plat_cond);
+    pthread_mutex_destroy(&self->plat_mutex);
+#   elif defined(SN_ON_WIN32)
+    CloseHandle(self->plat_event);
+#   endif
+#endif
+    plat_free(self);
+}
+
+void plat_event_signal(plat_event_c self)
+{
+    if (!self) return;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    pthread_mutex_lock(&self->plat_mutex);
+    self->signalled = 1;
+    pthread_cond_signal(&self->plat_cond);
+    pthread_mutex_unlock(&self->plat_mutex);
+#   elif defined(SN_ON_WIN32)
+    SetEvent(self->plat_event);
+#   endif
+#endif
+}
+
+int plat_event_wait(plat_event_c self, uint32_t timeout_ms)
+{
+    if (!self) return 0;
+#ifdef SN_CONFIG_ENABLE_MUTEX
+#   ifdef SN_ON_UNIX
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&self->plat_mutex);
+    while (!self->signalled)
+    {
+        if (pthread_cond_timedwait(&self->plat_cond, &self->plat_mutex, &deadline) != 0)
+            break;
+    }
+    const int signalled = self->signalled;
+    self->signalled = 0;
+    pthread_mutex_unlock(&self->plat_mutex);
+    return signalled;
+#   elif defined(SN_ON_WIN32)
+    return WaitForSingleObject(self->plat_event, timeout_ms) == WAIT_OBJECT_0;
+#   endif
+#else
+    (void)timeout_ms;
+    return 0;
+#endif
+}
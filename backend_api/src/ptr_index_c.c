@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#include "ptr_index_c.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "platform_independent/plat_allocators.h"
+
+static size_t ptr_index_pri_hash(const void* key, size_t mask)
+{
+    // Fibonacci hashing, the low bits of heap pointers are mostly alignment padding
+    uint64_t h = (uint64_t)(uintptr_t)key;
+    h ^= h >> 33;
+    h *= 0x9E3779B97F4A7C15ULL;
+    h ^= h >> 29;
+    return (size_t)h & mask;
+}
+
+static SN_BOOL ptr_index_pri_rehash(ptr_index_c self, size_t new_capacity)
+{
+    ptr_index_slot_t* new_slots = plat_calloc(new_capacity, sizeof(ptr_index_slot_t));
+    if (!new_slots) return SN_FALSE;
+
+    const size_t mask = new_capacity - 1;
+    for (size_t i = 0; i < self->capacity; i++)
+    {
+        if (!self->slots[i].key) continue;
+        size_t pos = ptr_index_pri_hash(self->slots[i].key, mask);
+        while (new_slots[pos].key)
+            pos = (pos + 1) & mask;
+        new_slots[pos] = self->slots[i];
+    }
+
+    plat_free(self->slots);
+    self->slots = new_slots;
+    self->capacity = new_capacity;
+    return SN_TRUE;
+}
+
+ptr_index_c ptr_index_new(size_t initial_capacity)
+{
+    ptr_index_c self = plat_malloc(sizeof(ptr_index_t));
+    if (!self) return NULL;
+    memset(self, 0, sizeof(ptr_index_t));
+
+    size_t capacity = PTR_INDEX_MIN_CAPACITY;
+    while (capacity < initial_capacity)
+        capacity <<= 1;
+
+    self->slots = plat_calloc(capacity, sizeof(ptr_index_slot_t));
+    if (!self->slots)
+    {
+        plat_free(self);
+        return NULL;
+    }
+    self->capacity = capacity;
+
+    return self;
+}
+
+void ptr_index_destroy(ptr_index_c self)
+{
+    if (!self) return;
+    plat_free(self->slots);
+    plat_free(self);
+}
+
+SN_BOOL ptr_index_put(ptr_index_c self, void* key, void* value)
+{
+    if (!self || !key) return SN_FALSE;
+
+    // Keep the load factor under 70% so probe chains stay short
+    if ((self->count + 1) * 10 > self->capacity * 7)
+    {
+        if (!ptr_index_pri_rehash(self, self->capacity << 1)) return SN_FALSE;
+    }
+
+    const size_t mask = self->capacity - 1;
+    size_t pos = ptr_index_pri_hash(key, mask);
+    while (self->slots[pos].key)
+    {
+        if (self->slots[pos].key == key) return SN_FALSE; // One value per key, remove the old one first
+        pos = (pos + 1) & mask;
+    }
+
+    self->slots[pos].key = key;
+    self->slots[pos].value = value;
+    self->count++;
+    return SN_TRUE;
+}
+
+void* ptr_index_get(ptr_index_c self, const void* key)
+{
+    if (!self || !key) return NULL;
+
+    const size_t mask = self->capacity - 1;
+    size_t pos = ptr_index_pri_hash(key, mask);
+    while (self->slots[pos].key)
+    {
+        if (self->slots[pos].key == key)
+            return self->slots[pos].value;
+        pos = (pos + 1) & mask;
+    }
+    return NULL;
+}
+
+void* ptr_index_remove(ptr_index_c self, const void* key)
+{
+    if (!self || !key) return NULL;
+
+    const size_t mask = self->capacity - 1;
+    size_t pos = ptr_index_pri_hash(key, mask);
+    while (self->slots[pos].key && self->slots[pos].key != key)
+        pos = (pos + 1) & mask;
+
+    if (!self->slots[pos].key) return NULL;
+
+    void* value = self->slots[pos].value;
+
+    // Backward shift deletion, no tombstones so lookups never degrade over time
+    size_t hole = pos;
+    size_t next = (pos + 1) & mask;
+    while (self->slots[next].key)
+    {
+        const size_t home = ptr_index_pri_hash(self->slots[next].key, mask);
+        // Only move the entry if the hole lies cyclically between its home and its current slot
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            self->slots[hole] = self->slots[next];
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    self->slots[hole].key = NULL;
+    self->slots[hole].value = NULL;
+    self->count--;
+
+    return value;
+}
+
+size_t ptr_index_getCount(ptr_index_c self)
+{
+    if (!self) return 0;
+    return self->count;
+}
@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#include "registry_c.h"
+
+#include <string.h>
+
+#include "platform_independent/plat_allocators.h"
+#include "stats_c.h"
+
+#if (REGISTRY_SHARD_COUNT & (REGISTRY_SHARD_COUNT - 1)) != 0 || REGISTRY_SHARD_COUNT < 1
+#   error "SN_CONFIG_REGISTRY_SHARD_COUNT must be a power of two"
+#endif
+
+static size_t registry_pri_shardOf(const void* key)
+{
+    if (REGISTRY_SHARD_COUNT == 1) return 0;
+
+    // Fibonacci hashing, the high half so we don't correlate with the per shard ptr_index which uses the low ones
+    // and the low bits of heap pointers are mostly alignment anyway
+    const uint64_t h = (uint64_t)(uintptr_t)key * UINT64_C(11400714819323198485);
+    return (size_t)((h >> 32) & (REGISTRY_SHARD_COUNT - 1));
+}
+
+registry_c registry_new()
+{
+    registry_c self = plat_malloc(sizeof(registry_t));
+    if (!self) return NULL;
+    memset(self, 0, sizeof(registry_t));
+
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        self->shards[i] = linked_list_new();
+    }
+
+    return self;
+}
+
+void registry_destroy(registry_c self)
+{
+    if (!self) return;
+
+    // Entries move between shards on realloc but always go back to the pool they came from,
+    // so no pool can go until every shard is done walking its entries
+    node_pool_c pools[REGISTRY_SHARD_COUNT];
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        pools[i] = self->shards[i]->pool;
+        self->shards[i]->pool = NULL;
+    }
+
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        linked_list_destroy(self->shards[i]);
+    }
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        node_pool_destroy(pools[i]);
+    }
+    plat_free(self);
+}
+
+linked_list_c registry_getShard(registry_c self, const void* key)
+{
+    if (!self) return NULL;
+    return self->shards[registry_pri_shardOf(key)];
+}
+
+linked_list_entry_c registry_push(registry_c self, void* data, size_t size, sn_tid_t tid)
+{
+    return linked_list_push(registry_getShard(self, data), data, size, tid);
+}
+
+SN_BOOL registry_removeEntry(registry_c self, linked_list_entry_c entry_ref)
+{
+    if (!entry_ref) return SN_FALSE;
+    return linked_list_removeEntry(registry_getShard(self, entry_ref->data), entry_ref);
+}
+
+// Counting sort of count (<= REGISTRY_BATCH_CHUNK) keys by shard
+// order[k] is the index of the k-th key in shard order, shard s owns order[starts[s]] .. order[starts[s + 1] - 1]
+static void registry_pri_groupByShard(void* const* keys, size_t count, size_t* order, size_t* starts)
+{
+    size_t shard_of[REGISTRY_BATCH_CHUNK];
+    size_t fill[REGISTRY_SHARD_COUNT];
+    memset(starts, 0, sizeof(size_t) * (REGISTRY_SHARD_COUNT + 1));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        shard_of[i] = registry_pri_shardOf(keys[i]);
+        starts[shard_of[i] + 1]++;
+    }
+    for (size_t s = 0; s < REGISTRY_SHARD_COUNT; s++)
+    {
+        starts[s + 1] += starts[s];
+        fill[s] = starts[s];
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        order[fill[shard_of[i]]++] = i;
+    }
+}
+
+void registry_pushBatch(registry_c self, void* const* data, const size_t* sizes, size_t count, sn_tid_t tid, linked_list_entry_c* out)
+{
+    if (!self || !data || !sizes || !out) return;
+
+    size_t order[REGISTRY_BATCH_CHUNK];
+    size_t starts[REGISTRY_SHARD_COUNT + 1];
+    void* group_data[REGISTRY_BATCH_CHUNK];
+    size_t group_sizes[REGISTRY_BATCH_CHUNK];
+    linked_list_entry_c group_entries[REGISTRY_BATCH_CHUNK];
+
+    for (size_t base = 0; base < count; base += REGISTRY_BATCH_CHUNK)
+    {
+        const size_t n = count - base < REGISTRY_BATCH_CHUNK ? count - base : REGISTRY_BATCH_CHUNK;
+        registry_pri_groupByShard(data + base, n, order, starts);
+
+        for (size_t k = 0; k < n; k++)
+        {
+            group_data[k] = data[base + order[k]];
+            group_sizes[k] = sizes[base + order[k]];
+        }
+
+        for (size_t s = 0; s < REGISTRY_SHARD_COUNT; s++)
+        {
+            const size_t first = starts[s];
+            linked_list_pushBatch(self->shards[s], group_data + first, group_sizes + first, starts[s + 1] - first, tid, group_entries + first);
+        }
+
+        for (size_t k = 0; k < n; k++)
+        {
+            out[base + order[k]] = group_entries[k];
+        }
+    }
+}
+
+void registry_removeBatch(registry_c self, linked_list_entry_c* entries, size_t count)
+{
+    if (!self || !entries) return;
+
+    size_t order[REGISTRY_BATCH_CHUNK];
+    size_t starts[REGISTRY_SHARD_COUNT + 1];
+    void* keys[REGISTRY_BATCH_CHUNK];
+    linked_list_entry_c group_entries[REGISTRY_BATCH_CHUNK];
+
+    for (size_t base = 0; base < count; base += REGISTRY_BATCH_CHUNK)
+    {
+        const size_t n = count - base < REGISTRY_BATCH_CHUNK ? count - base : REGISTRY_BATCH_CHUNK;
+        for (size_t k = 0; k < n; k++)
+        {
+            keys[k] = entries[base + k] ? entries[base + k]->data : NULL;
+        }
+        registry_pri_groupByShard(keys, n, order, starts);
+
+        for (size_t k = 0; k < n; k++)
+        {
+            group_entries[k] = entries[base + order[k]];
+        }
+
+        for (size_t s = 0; s < REGISTRY_SHARD_COUNT; s++)
+        {
+            const size_t first = starts[s];
+            linked_list_removeBatch(self->shards[s], group_entries + first, starts[s + 1] - first);
+        }
+    }
+}
+
+void registry_rekeyEntry(registry_c self, linked_list_entry_c entry_ref, void* new_data)
+{
+    if (!self || !entry_ref) return;
+
+    linked_list_c from = registry_getShard(self, entry_ref->data);
+    linked_list_c to = registry_getShard(self, new_data);
+
+    if (from == to)
+    {
+        linked_list_rekeyEntry(from, entry_ref, new_data);
+        return;
+    }
+
+    // The entry is briefly in neither shard, fine since nobody has the new pointer yet
+    // The key only changes under the destination's lock, never while no lock covers the entry
+    linked_list_detachEntry(from, entry_ref);
+    linked_list_attachEntry(to, entry_ref, new_data);
+}
+
+SN_BOOL registry_detachEntry(registry_c self, linked_list_entry_c entry_ref)
+{
+    if (!entry_ref) return SN_FALSE;
+    return linked_list_detachEntry(registry_getShard(self, entry_ref->data), entry_ref);
+}
+
+void registry_attachEntry(registry_c self, linked_list_entry_c entry_ref)
+{
+    if (!entry_ref) return;
+    linked_list_attachEntry(registry_getShard(self, entry_ref->data), entry_ref, entry_ref->data);
+}
+
+void registry_resizeEntry(registry_c self, linked_list_entry_c entry_ref, size_t new_size)
+{
+    if (!entry_ref) return;
+    linked_list_resizeEntry(registry_getShard(self, entry_ref->data), entry_ref, new_size);
+}
+
+linked_list_entry_c registry_getByPtr(registry_c self, void* key)
+{
+    return linked_list_getByPtr(registry_getShard(self, key), key);
+}
+
+SN_BOOL registry_hasPtr(registry_c self, void* key)
+{
+    return linked_list_hasPtr(registry_getShard(self, key), key);
+}
+
+linked_list_entry_c registry_getById(registry_c self, uint16_t id)
+{
+    if (!self) return NULL;
+    stats_inc(STATS_LOOKUP_SCAN); // One lookup, however many shards it walks
+
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        linked_list_entry_c entry = linked_list_getById(self->shards[i], id);
+        if (entry) return entry;
+    }
+    return NULL;
+}
+
+linked_list_entry_c registry_getContaining(registry_c self, const void* addr)
+{
+    if (!self || !addr) return NULL;
+    stats_inc(STATS_LOOKUP_INDEX);
+
+    // Blocks are sharded by their start address so the containing one can be in any shard
+    // at most one of them can actually contain addr unless blocks overlap
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        linked_list_entry_c entry = linked_list_getContaining(self->shards[i], addr);
+        if (entry) return entry;
+    }
+    return NULL;
+}
+
+size_t registry_getSize(registry_c self)
+{
+    if (!self) return 0;
+
+    size_t total = 0;
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        total += linked_list_getSize(self->shards[i]);
+    }
+    return total;
+}
+
+size_t registry_getBytes(registry_c self)
+{
+    if (!self) return 0;
+
+    size_t total = 0;
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        total += linked_list_getBytes(self->shards[i]);
+    }
+    return total;
+}
+
+typedef struct
+{
+    linked_list_for_each_worker_f worker;
+    void* generic_arg;
+    size_t index;
+    SN_BOOL broke;
+} registry_pri_for_each_t;
+
+static linked_list_entry_c registry_pri_forEachWorker(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
+{
+    registry_pri_for_each_t* state = generic_arg;
+    linked_list_entry_c temp = state->worker(self, ctx, state->index++, state->generic_arg);
+    if (temp == LIST_FOR_EACH_LOOP_BRAKE)
+        state->broke = SN_TRUE;
+    return temp;
+}
+
+linked_list_entry_c registry_forEach(registry_c self, linked_list_for_each_worker_f worker, void* generic_arg)
+{
+    if (!self || !worker) return NULL;
+
+    registry_pri_for_each_t state = {
+        .worker = worker,
+        .generic_arg = generic_arg,
+        .index = 0,
+        .broke = SN_FALSE
+    };
+
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        linked_list_entry_c temp = linked_list_forEach(self->shards[i], &registry_pri_forEachWorker, &state);
+        if (temp) return temp;
+        if (state.broke) return NULL;
+    }
+    return NULL;
+}
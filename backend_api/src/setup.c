@@ -19,6 +19,10 @@
 #include <string.h>
 
 #include "linked_list_c.h"
+#include "sn_block.h"
+#include "sn_crash.h"
+#include "platform_independent/plat_allocators.h"
+#include "platform_independent/plat_atomic.h"
 
 #include "libsafetynet.h"
 #include "_pri_api.h"
@@ -30,38 +34,88 @@
 
 
 
-linked_list_c mem_list = NULL;
+registry_c mem_registry = NULL;
 plat_mutex_c alloc_mutex = NULL;
 alloc_manager_m memory_manager = NULL;
+id_table_c block_id_table = NULL;
+thread_usage_c thread_usage = NULL;
+tag_usage_c tag_usage = NULL;
+thread_cache_c thread_cache = NULL;
 SN_FLAG doFree = 1;
+SN_FLAG doTeardown = 1;
 
 static linked_list_entry_c freeOnListFree(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
 {
     if (!doFree) return NULL;
     //if (!ctx) sn_debug_crash();
-#ifdef SN_CONFIG_SANITIZE_MEMORY_ON_FREE
-    memset(ctx->data, 0, ctx->size);
-#endif
-    free(ctx->data);
+    if (memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_FREE, ctx->size))
+        sn_block_sanitize(ctx);
+    sn_block_release(ctx);
     return NULL;
 }
 
 static inline void doexit()
 {
-    if (linked_list_getSize(mem_list))
+    sn_pri_maintenance_shutdown(); // Its thread walks everything below, it has to be gone first
+    if (registry_getSize(mem_registry))
     {
-        linked_list_forEach(mem_list, &freeOnListFree, NULL);
+        registry_forEach(mem_registry, &freeOnListFree, NULL);
     }
+    thread_cache_destroy(thread_cache); // Parked nodes go back to the registry pools first
     plat_mutex_destroy(alloc_mutex);
-    linked_list_destroy(mem_list);
+    registry_destroy(mem_registry);
     memman_destroy(memory_manager);
+    id_table_destroy(block_id_table);
+    thread_usage_destroy(thread_usage);
+    tag_usage_destroy(tag_usage);
+
+    // Destructors of other shared objects can still come through here, they must see a library that is gone
+    mem_registry = NULL;
+    alloc_mutex = NULL;
+    memory_manager = NULL;
+    block_id_table = NULL;
+    thread_usage = NULL;
+    tag_usage = NULL;
+    thread_cache = NULL;
+    stats_shutdown();
 }
 
 static inline void doinit()
 {
-    mem_list = linked_list_new();
+    mem_registry = registry_new();
     alloc_mutex = plat_mutex_new();
-    memory_manager = memman_new(alloc_mutex);
+    memory_manager = memman_new(mem_registry);
+    block_id_table = id_table_new();
+    thread_usage = thread_usage_new();
+    tag_usage = tag_usage_new();
+    thread_cache = thread_cache_new();
+
+    if (!mem_registry || !block_id_table || !thread_usage || !tag_usage || !thread_cache || !sn_pri_maintenance_init() || !stats_init())
+    {
+        sn_crash(SN_ERR_CATASTROPHIC);
+    }
+}
+
+// 0 until doinit ran, 1 while it runs, 2 after (also after doexit, a library that shut down stays down)
+static int init_state = 0;
+
+SN_BOOL sn_pri_lazy_init()
+{
+    int expected = 0;
+    if (plat_atomic_cas(&init_state, &expected, 1))
+    {
+        doinit();
+        plat_atomic_store(&init_state, 2);
+    }
+    else
+    {
+        while (plat_atomic_load(&init_state) != 2)
+        {
+            // Another thread is in doinit, it does not take long
+        }
+    }
+
+    return mem_registry != NULL;
 }
 
 #if defined(SN_ON_WIN32) && !defined(SN_CONFIG_STATIC_ONLY)
@@ -77,7 +131,7 @@ BOOL WINAPI DllMain(
         case DLL_PROCESS_ATTACH:
             // Initialize once for each new process.
             // Return FALSE to fail DLL load.
-            doinit();
+            sn_pri_lazy_init();
             break;
         case DLL_PROCESS_DETACH:
 
@@ -87,7 +141,8 @@ BOOL WINAPI DllMain(
             }
 
             // Perform any necessary cleanup.
-            doexit();
+            if (plat_atomic_load(&doTeardown))
+                doexit();
             break;
         default:
             break;
@@ -99,7 +154,7 @@ BOOL WINAPI DllMain(
 __attribute__((constructor))
 void library_init()
 {
-    doinit();
+    sn_pri_lazy_init();
 }
 
 // Destructor: Called when the library is unloaded
@@ -108,7 +163,14 @@ void library_cleanup()
 {
     // Perform any necessary cleanup, such as freeing global memory or other resources.
     // This function is called when the shared library is unloaded.
-    doexit();
+#ifdef BUILDING_SAFETYNET_PRELOAD
+    // As the process wide malloc, destructors and libc itself still free blocks after this runs
+    // so everything stays up and the OS takes it back
+#else
+    // Same story when the program asked for it (safetynet.hpp does with SN_CPP_REPLACE_GLOBAL_NEW)
+    if (plat_atomic_load(&doTeardown))
+        doexit();
+#endif
 }
 #endif
 
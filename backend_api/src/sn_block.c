@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#include "sn_block.h"
+
+#include "platform_independent/plat_allocators.h"
+#include "thread_cache_c.h"
+
+// Never probe across a page boundary, a foreign pointer may sit at the very start of a mapping
+#define SN_BLOCK_PROBE_PAGE_SIZE 4096
+
+// The probe reads in front of pointers that may not be ours, on purpose, keep ASan builds usable
+#if defined(SN_ON_GCC) || defined(SN_ON_CLANG)
+#   define SN_BLOCK_PRI_NO_ASAN __attribute__((no_sanitize_address))
+#else
+#   define SN_BLOCK_PRI_NO_ASAN
+#endif
+
+static sn_block_header_t* sn_block_pri_header(const void* user_ptr)
+{
+    return (sn_block_header_t*)((uint8_t*)user_ptr - SN_BLOCK_HEADER_SIZE);
+}
+
+void sn_block_headerInstall(void* user_ptr, linked_list_entry_c entry)
+{
+    if (!user_ptr || !entry) return;
+    sn_block_header_t* header = sn_block_pri_header(user_ptr);
+    header->entry = entry;
+    header->magic = SN_BLOCK_HEADER_MAGIC ^ (uintptr_t)user_ptr ^ (uintptr_t)entry;
+    entry->flags |= SN_BLOCK_FLAG_INLINE_HEADER;
+}
+
+void sn_block_headerClear(void* user_ptr)
+{
+    if (!user_ptr) return;
+    sn_block_header_t* header = sn_block_pri_header(user_ptr);
+    header->entry = NULL;
+    header->magic = 0;
+}
+
+SN_BLOCK_PRI_NO_ASAN linked_list_entry_c sn_block_headerProbe(const void* user_ptr)
+{
+    if (!user_ptr) return NULL;
+    if (((uintptr_t)user_ptr & (SN_BLOCK_PROBE_PAGE_SIZE - 1)) < SN_BLOCK_HEADER_SIZE) return NULL;
+
+    const sn_block_header_t* header = sn_block_pri_header(user_ptr);
+    const linked_list_entry_c entry = header->entry;
+
+    if (!entry) return NULL;
+    if (header->magic != (SN_BLOCK_HEADER_MAGIC ^ (uintptr_t)user_ptr ^ (uintptr_t)entry)) return NULL;
+    if (entry->data != user_ptr || !(entry->flags & SN_BLOCK_FLAG_INLINE_HEADER)) return NULL;
+
+    return entry;
+}
+
+void* sn_block_getBase(linked_list_entry_c entry)
+{
+    if (!entry) return NULL;
+    if (entry->flags & SN_BLOCK_FLAG_INLINE_HEADER)
+        return (uint8_t*)entry->data - SN_BLOCK_HEADER_SIZE;
+    return entry->data;
+}
+
+size_t sn_block_mappedLength(size_t header_size, size_t size)
+{
+    const size_t page = plat_getPageSize();
+    return (header_size + size + page - 1) & ~(page - 1);
+}
+
+size_t sn_block_getMappedLength(linked_list_entry_c entry)
+{
+    if (!entry) return 0;
+    const size_t header_size = (entry->flags & SN_BLOCK_FLAG_INLINE_HEADER) ? SN_BLOCK_HEADER_SIZE : 0;
+    // size may have grown in place since the mapping was made, usable still covers exactly the mapped pages
+    return sn_block_mappedLength(header_size, entry->usable > entry->size ? entry->usable : entry->size);
+}
+
+size_t sn_block_queryUsable(linked_list_entry_c entry)
+{
+    if (!entry) return 0;
+    const size_t header_size = (entry->flags & SN_BLOCK_FLAG_INLINE_HEADER) ? SN_BLOCK_HEADER_SIZE : 0;
+
+    size_t usable = 0;
+    if (entry->flags & SN_BLOCK_FLAG_MAPPED)
+        usable = sn_block_mappedLength(header_size, entry->size) - header_size;
+    else if (entry->flags & SN_BLOCK_FLAG_SIZE_CLASS)
+        usable = thread_cache_classSize(entry->size);
+    else if (!(entry->flags & SN_BLOCK_FLAG_ALIGNED))
+    {
+        const size_t total = plat_backend_usableSize(entry->backend, sn_block_getBase(entry));
+        usable = total > header_size ? total - header_size : 0;
+    }
+
+    return usable > entry->size ? usable : entry->size;
+}
+
+void sn_block_release(linked_list_entry_c entry)
+{
+    if (!entry) return;
+    if (entry->flags & SN_BLOCK_FLAG_MAPPED)
+        plat_unmap(sn_block_getBase(entry), sn_block_getMappedLength(entry));
+    else if (entry->flags & SN_BLOCK_FLAG_ALIGNED)
+        plat_aligned_free(sn_block_getBase(entry));
+    else
+        plat_backend_free(entry->backend, sn_block_getBase(entry));
+}
+
+size_t sn_block_getAlignment(linked_list_entry_c entry)
+{
+    if (!entry || !(entry->flags & SN_BLOCK_FLAG_ALIGNED)) return 0;
+    return (size_t)1 << entry->align_log2;
+}
+
+void sn_block_clear(void* ptr, size_t size, SN_BOOL may_discard)
+{
+    if (!ptr || !size) return;
+    if (may_discard && size >= SN_BLOCK_DISCARD_MIN)
+        plat_discardPages(ptr, size);
+    else
+        plat_clear(ptr, size);
+}
+
+void sn_block_sanitize(linked_list_entry_c entry)
+{
+    if (!entry || (entry->flags & SN_BLOCK_FLAG_MAPPED)) return;
+    // A custom backend might hand out shared or file backed memory where dropping pages doesn't zero them
+    sn_block_clear(entry->data, entry->size, entry->backend == PLAT_BACKEND_LIBC);
+}
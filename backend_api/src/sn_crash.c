@@ -55,6 +55,7 @@ static int print_node(const linked_list_entry_c node)
     pcc += sn_crash_print("isHead: %i\n", node->isHead);
     pcc += sn_crash_print("next: %p\n", node->next);
     pcc += sn_crash_print("weight : %x\n", node->_weight);
+    pcc += sn_crash_print("flags : %x\n", node->flags);
     return pcc;
 }
 
@@ -130,12 +131,16 @@ SN_NO_RETURN void __sn__pri__crash__(const sn_error_codes_e err, const uint32_t
     if (err == SN_ERR_SYS_FAIL) goto EX1;
 
     sn_crash_print("Memory tracking list state:\n");
-    sn_crash_print("\nlast_access_node:\n");
-    print_node(mem_list->lastAccess);
+    for (size_t i = 0; i < REGISTRY_SHARD_COUNT; i++)
+    {
+        if (!mem_registry->shards[i]->lastAccess) continue;
+        sn_crash_print("\nlast_access_node(shard %zu):\n", i);
+        print_node(mem_registry->shards[i]->lastAccess);
+    }
 #ifdef SN_CONFIG_ENABLE_DUMP_LIST_CRASH
     sn_crash_print("\n\n");
     sn_crash_print("nodes:\n");
-    linked_list_forEach(mem_list, &list_nodeas, NULL);
+    registry_forEach(mem_registry, &list_nodeas, NULL);
 #endif
 
 EX1:
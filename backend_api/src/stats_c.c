@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+#include "stats_c.h"
+
+#include <string.h>
+
+#include "platform_independent/plat_allocators.h"
+
+static stats_block_t* stats_blocks = NULL;
+static plat_tls_key_c stats_key = NULL;
+plat_thread_local_hot stats_block_t* stats_local = NULL;
+
+static size_t stats_peak_bytes = 0;
+static size_t stats_peak_blocks = 0;
+
+static void stats_pri_onThreadExit(void* value)
+{
+    stats_block_t* block = value;
+    if (!block) return;
+    stats_local = NULL; // In case a later destructor on this thread counts something, it claims a block anew
+    plat_atomic_store(&block->in_use, SN_FLAG_UNSET);
+}
+
+static stats_block_t* stats_pri_claim()
+{
+    // A block a dead thread left behind first, its counts stay in the totals either way
+    for (stats_block_t* block = plat_atomic_load(&stats_blocks); block; block = block->next)
+    {
+        SN_FLAG expected = SN_FLAG_UNSET;
+        if (!plat_atomic_load_relaxed(&block->in_use) && plat_atomic_cas(&block->in_use, &expected, SN_FLAG_SET))
+            return block;
+    }
+
+    stats_block_t* block = plat_malloc(sizeof(stats_block_t));
+    if (!block) return NULL;
+    memset(block, 0, sizeof(stats_block_t));
+    block->in_use = SN_FLAG_SET;
+
+    stats_block_t* head = plat_atomic_load_relaxed(&stats_blocks);
+    do
+    {
+        block->next = head;
+    }
+    while (!plat_atomic_cas(&stats_blocks, &head, block));
+    return block;
+}
+
+SN_BOOL stats_init()
+{
+    stats_key = plat_tls_key_new(&stats_pri_onThreadExit);
+    return stats_key != NULL;
+}
+
+void stats_shutdown()
+{
+    plat_tls_key_c key = stats_key;
+    stats_key = NULL;
+    plat_tls_key_destroy(key);
+}
+
+stats_block_t* stats_pri_claimLocal()
+{
+    stats_block_t* block = stats_pri_claim();
+    if (!block) return NULL;
+    stats_local = block;
+    if (stats_key) plat_tls_set(stats_key, block);
+    return block;
+}
+
+void stats_sum(uint64_t* out)
+{
+    memset(out, 0, sizeof(uint64_t) * STATS_COUNTER_COUNT);
+    for (stats_block_t* block = plat_atomic_load(&stats_blocks); block; block = block->next)
+    {
+        for (size_t i = 0; i < STATS_COUNTER_COUNT; i++)
+            out[i] += plat_atomic_load_relaxed(&block->counters[i]);
+    }
+}
+
+static void stats_pri_raise(size_t* peak, size_t value)
+{
+    size_t current = plat_atomic_load_relaxed(peak);
+    while (value > current && !plat_atomic_cas(peak, &current, value))
+    {
+    }
+}
+
+void stats_notePeak(size_t bytes, size_t blocks)
+{
+    stats_pri_raise(&stats_peak_bytes, bytes);
+    stats_pri_raise(&stats_peak_blocks, blocks);
+}
+
+void stats_getPeak(size_t* bytes, size_t* blocks)
+{
+    if (bytes) *bytes = plat_atomic_load_relaxed(&stats_peak_bytes);
+    if (blocks) *blocks = plat_atomic_load_relaxed(&stats_peak_blocks);
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+//
+
+#include "tag_usage_c.h"
+
+#include <string.h>
+
+#include "platform_independent/plat_allocators.h"
+#include "platform_independent/plat_atomic.h"
+
+tag_usage_c tag_usage_new()
+{
+    tag_usage_c self = plat_malloc(sizeof(tag_usage_t));
+    if (!self) return NULL;
+    memset(self, 0, sizeof(tag_usage_t));
+
+    self->mutex = plat_mutex_new();
+    if (!self->mutex)
+    {
+        plat_free(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void tag_usage_destroy(tag_usage_c self)
+{
+    if (!self) return;
+
+    tag_usage_node_t* node = self->nodes;
+    while (node)
+    {
+        tag_usage_node_t* next = node->next;
+        plat_free(node);
+        node = next;
+    }
+
+    plat_mutex_destroy(self->mutex);
+    plat_free(self);
+}
+
+tag_usage_node_t* tag_usage_getNode(tag_usage_c self, tag_usage_node_t* parent, const char* name)
+{
+    if (!self || !name) return NULL;
+    if (parent && parent->depth >= TAG_USAGE_MAX_DEPTH) return NULL;
+
+    plat_mutex_lock(self->mutex);
+    tag_usage_node_t* node = self->nodes;
+    for (; node; node = node->next)
+    {
+        if (node->parent == parent && strncmp(node->name, name, TAG_USAGE_NAME_MAX - 1) == 0) break;
+    }
+
+    if (!node)
+    {
+        node = plat_malloc(sizeof(tag_usage_node_t));
+        if (node)
+        {
+            memset(node, 0, sizeof(tag_usage_node_t));
+            strncpy(node->name, name, TAG_USAGE_NAME_MAX - 1);
+            node->parent = parent;
+            node->depth = (uint8_t)(parent ? parent->depth + 1 : 1);
+            node->next = self->nodes;
+            self->nodes = node;
+            self->node_count++;
+        }
+    }
+    plat_mutex_unlock(self->mutex);
+
+    return node;
+}
+
+static void tag_usage_pri_notePeak(tag_usage_node_t* node, size_t now)
+{
+    size_t peak = plat_atomic_load_relaxed(&node->peak_bytes);
+    while (now > peak && !plat_atomic_cas(&node->peak_bytes, &peak, now))
+    {
+        // peak was reloaded by the failed CAS
+    }
+}
+
+SN_BOOL tag_usage_tryCharge(tag_usage_node_t* node, size_t bytes)
+{
+    for (tag_usage_node_t* at = node; at; at = at->parent)
+    {
+        const size_t now = plat_atomic_fetch_add(&at->bytes, bytes) + bytes;
+        const size_t limit = plat_atomic_load_relaxed(&at->limit);
+
+        if (limit && now > limit)
+        {
+            // Back out of at and everything below it that was already charged
+            for (tag_usage_node_t* undo = node; undo != at->parent; undo = undo->parent)
+                plat_atomic_fetch_sub(&undo->bytes, bytes);
+            return SN_FALSE;
+        }
+        tag_usage_pri_notePeak(at, now);
+    }
+    return SN_TRUE;
+}
+
+void tag_usage_charge(tag_usage_node_t* node, size_t bytes, size_t blocks)
+{
+    for (tag_usage_node_t* at = node; at; at = at->parent)
+    {
+        const size_t now = plat_atomic_fetch_add(&at->bytes, bytes) + bytes;
+        plat_atomic_fetch_add(&at->blocks, blocks);
+        tag_usage_pri_notePeak(at, now);
+    }
+}
+
+void tag_usage_uncharge(tag_usage_node_t* node, size_t bytes, size_t blocks)
+{
+    for (tag_usage_node_t* at = node; at; at = at->parent)
+    {
+        plat_atomic_fetch_sub(&at->bytes, bytes);
+        plat_atomic_fetch_sub(&at->blocks, blocks);
+    }
+}
+
+size_t tag_usage_snapshot(tag_usage_c self, sn_tag_usage_t* out, size_t max_count)
+{
+    if (!self) return 0;
+
+    plat_mutex_lock(self->mutex);
+    size_t i = 0;
+    for (tag_usage_node_t* node = self->nodes; node && i < max_count && out; node = node->next, i++)
+    {
+        out[i].tag = (sn_tag_t*)node;
+        out[i].parent = (sn_tag_t*)node->parent;
+        out[i].name = node->name;
+        out[i].bytes = plat_atomic_load_relaxed(&node->bytes);
+        out[i].blocks = plat_atomic_load_relaxed(&node->blocks);
+        out[i].peak_bytes = plat_atomic_load_relaxed(&node->peak_bytes);
+        out[i].limit = plat_atomic_load_relaxed(&node->limit);
+    }
+    const size_t count = self->node_count;
+    plat_mutex_unlock(self->mutex);
+
+    return count;
+}
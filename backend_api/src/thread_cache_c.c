@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#include "thread_cache_c.h"
+
+#include <string.h>
+
+#include "sn_block.h"
+#include "sn_crash.h"
+#include "platform_independent/plat_allocators.h"
+
+static size_t thread_cache_pri_classOf(size_t size)
+{
+    return (size + THREAD_CACHE_GRANULE - 1) / THREAD_CACHE_GRANULE - 1;
+}
+
+static void thread_cache_pri_drain(thread_cache_record_t* record)
+{
+    for (size_t i = 0; i < THREAD_CACHE_CLASS_COUNT; i++)
+    {
+        linked_list_entry_c entry = record->bins[i];
+        while (entry)
+        {
+            linked_list_entry_c next = entry->next;
+            sn_block_release(entry);
+            linked_list_entry_destroy(entry);
+            entry = next;
+        }
+        record->bins[i] = NULL;
+        record->counts[i] = 0;
+    }
+}
+
+// Caller must hold the table mutex
+static void thread_cache_pri_unlink(thread_cache_c self, thread_cache_record_t* record)
+{
+    if (record->previous)
+        record->previous->next = record->next;
+    else
+        self->records = record->next;
+
+    if (record->next)
+        record->next->previous = record->previous;
+}
+
+static void thread_cache_pri_onThreadExit(void* value)
+{
+    thread_cache_record_t* record = value;
+    if (!record) return;
+
+    thread_cache_c self = record->owner;
+    plat_mutex_lock(self->mutex);
+    thread_cache_pri_unlink(self, record);
+    plat_mutex_unlock(self->mutex);
+
+    thread_cache_pri_drain(record);
+    plat_free(record);
+}
+
+thread_cache_c thread_cache_new()
+{
+    thread_cache_c self = plat_malloc(sizeof(thread_cache_t));
+    if (!self) return NULL;
+    memset(self, 0, sizeof(thread_cache_t));
+
+    self->key = plat_tls_key_new(&thread_cache_pri_onThreadExit);
+    self->mutex = plat_mutex_new();
+    if (!self->key || !self->mutex)
+    {
+        plat_tls_key_destroy(self->key);
+        plat_mutex_destroy(self->mutex);
+        plat_free(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void thread_cache_destroy(thread_cache_c self)
+{
+    if (!self) return;
+
+    // Delete the key first so no exiting thread can race us for its record
+    plat_tls_key_destroy(self->key);
+
+    plat_mutex_lock(self->mutex);
+    thread_cache_record_t* record = self->records;
+    while (record)
+    {
+        thread_cache_record_t* next = record->next;
+        thread_cache_pri_drain(record);
+        plat_free(record);
+        record = next;
+    }
+    self->records = NULL;
+    plat_mutex_unlock(self->mutex);
+
+    plat_mutex_destroy(self->mutex);
+    plat_free(self);
+}
+
+thread_cache_record_t* thread_cache_getRecord(thread_cache_c self)
+{
+    if (!self) return NULL;
+
+    thread_cache_record_t* record = plat_tls_get(self->key);
+    if (record) return record;
+
+    record = plat_malloc(sizeof(thread_cache_record_t));
+    if (!record)
+    {
+        sn_crash(SN_ERR_CATASTROPHIC);
+    }
+    memset(record, 0, sizeof(thread_cache_record_t));
+    record->owner = self;
+
+    plat_mutex_lock(self->mutex);
+    record->next = self->records;
+    if (self->records)
+        self->records->previous = record;
+    self->records = record;
+    plat_mutex_unlock(self->mutex);
+
+    plat_tls_set(self->key, record);
+    return record;
+}
+
+size_t thread_cache_classSize(size_t size)
+{
+    if (!size || size > THREAD_CACHE_MAX_BLOCK_SIZE) return 0;
+    return (thread_cache_pri_classOf(size) + 1) * THREAD_CACHE_GRANULE;
+}
+
+SN_BOOL thread_cache_recordHasRoom(const thread_cache_record_t* record, size_t size)
+{
+    if (!record || !thread_cache_classSize(size)) return SN_FALSE;
+    return record->counts[thread_cache_pri_classOf(size)] < THREAD_CACHE_BIN_DEPTH;
+}
+
+SN_BOOL thread_cache_recordPut(thread_cache_record_t* record, linked_list_entry_c entry)
+{
+    if (!entry || !thread_cache_recordHasRoom(record, entry->size)) return SN_FALSE;
+
+    const size_t class_index = thread_cache_pri_classOf(entry->size);
+    entry->previous = NULL;
+    entry->next = record->bins[class_index];
+    record->bins[class_index] = entry;
+    record->counts[class_index]++;
+    return SN_TRUE;
+}
+
+linked_list_entry_c thread_cache_recordTake(thread_cache_record_t* record, size_t size)
+{
+    if (!record || !thread_cache_classSize(size)) return NULL;
+
+    const size_t class_index = thread_cache_pri_classOf(size);
+    linked_list_entry_c entry = record->bins[class_index];
+    if (!entry) return NULL;
+
+    record->bins[class_index] = entry->next;
+    record->counts[class_index]--;
+    entry->next = NULL;
+    return entry;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#include "thread_usage_c.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "sn_crash.h"
+#include "platform_independent/plat_allocators.h"
+#include "platform_independent/plat_atomic.h"
+
+// ptr_index reserves NULL and tids can be 0 when threading is compiled out
+#define thread_usage_pri_key(tid) ((void*)(uintptr_t)((tid) + 1))
+
+thread_usage_c thread_usage_new()
+{
+    thread_usage_c self = plat_malloc(sizeof(thread_usage_t));
+    if (!self) return NULL;
+    memset(self, 0, sizeof(thread_usage_t));
+
+    self->by_tid = ptr_index_new(PTR_INDEX_MIN_CAPACITY);
+    self->mutex = plat_mutex_new();
+    if (!self->by_tid || !self->mutex)
+    {
+        ptr_index_destroy(self->by_tid);
+        plat_mutex_destroy(self->mutex);
+        plat_free(self);
+        return NULL;
+    }
+
+    return self;
+}
+
+void thread_usage_destroy(thread_usage_c self)
+{
+    if (!self) return;
+
+    thread_usage_record_t* record = self->records;
+    while (record)
+    {
+        thread_usage_record_t* next = record->next;
+        plat_free(record);
+        record = next;
+    }
+
+    ptr_index_destroy(self->by_tid);
+    plat_mutex_destroy(self->mutex);
+    plat_free(self);
+}
+
+thread_usage_record_t* thread_usage_getRecord(thread_usage_c self, sn_tid_t tid)
+{
+    if (!self) return NULL;
+
+    plat_mutex_lock(self->mutex);
+    thread_usage_record_t* record = ptr_index_get(self->by_tid, thread_usage_pri_key(tid));
+    if (!record)
+    {
+        record = plat_malloc(sizeof(thread_usage_record_t));
+        if (!record || !ptr_index_put(self->by_tid, thread_usage_pri_key(tid), record))
+        {
+            sn_crash(SN_ERR_CATASTROPHIC);
+        }
+        memset(record, 0, sizeof(thread_usage_record_t));
+        record->tid = tid;
+        record->next = self->records;
+        self->records = record;
+        self->record_count++;
+    }
+    plat_mutex_unlock(self->mutex);
+
+    return record;
+}
+
+thread_usage_record_t* thread_usage_findRecord(thread_usage_c self, sn_tid_t tid)
+{
+    if (!self) return NULL;
+
+    plat_mutex_lock(self->mutex);
+    thread_usage_record_t* record = ptr_index_get(self->by_tid, thread_usage_pri_key(tid));
+    plat_mutex_unlock(self->mutex);
+
+    return record;
+}
+
+void thread_usage_recordCharge(thread_usage_record_t* record, size_t bytes, size_t blocks)
+{
+    if (!record) return;
+
+    const size_t now = plat_atomic_fetch_add(&record->bytes, bytes) + bytes;
+    plat_atomic_fetch_add(&record->blocks, blocks);
+
+    size_t peak = plat_atomic_load_relaxed(&record->peak_bytes);
+    while (now > peak && !plat_atomic_cas(&record->peak_bytes, &peak, now))
+    {
+        // peak was reloaded by the failed CAS
+    }
+}
+
+void thread_usage_recordUncharge(thread_usage_record_t* record, size_t bytes, size_t blocks)
+{
+    if (!record) return;
+    plat_atomic_fetch_sub(&record->bytes, bytes);
+    plat_atomic_fetch_sub(&record->blocks, blocks);
+}
+
+size_t thread_usage_snapshot(thread_usage_c self, sn_thread_memory_usage_t* out, size_t max_count)
+{
+    if (!self) return 0;
+
+    plat_mutex_lock(self->mutex);
+    size_t i = 0;
+    for (thread_usage_record_t* record = self->records; record && i < max_count && out; record = record->next, i++)
+    {
+        out[i].tid = record->tid;
+        out[i].bytes = plat_atomic_load_relaxed(&record->bytes);
+        out[i].blocks = plat_atomic_load_relaxed(&record->blocks);
+        out[i].peak_bytes = plat_atomic_load_relaxed(&record->peak_bytes);
+    }
+    const size_t count = self->record_count;
+    plat_mutex_unlock(self->mutex);
+
+    return count;
+}
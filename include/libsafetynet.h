@@ -170,6 +170,10 @@ typedef enum
     SN_ERR_FILE_IO = 70,                 /**< Libc file IO error */
     SN_ERR_FILE_NOT_EXIST = 110,         /**< file Does not exist */
     SN_ERR_ALLOC_LIMIT_HIT = 120,        /**< User defined alloc limit has been hit */
+    SN_ERR_ARENA_FULL = 130,             /**< Arena has no room left for the allocation */
+    SN_ERR_BAD_ALIGNMENT = 135,          /**< Alignment is not a power of two */
+    SN_ERR_BACKEND_LIMIT = 140,          /**< No slot left to install another backend allocator */
+    SN_ERR_TAG_DEPTH = 145,              /**< Tag would be nested deeper than SN_TAG_MAX_DEPTH */
     SN_WARN_DUB_FREE = 180,              /**< Double free detected (warning) */
     SN_ERR_SYS_FAIL = 185,               /**< generic system failure (Start praying) */
     SN_ERR_CATASTROPHIC = 187,           /**< Catastrophic system error (like I said before pick a god and start praying) */
@@ -177,6 +181,14 @@ typedef enum
     SN_INFO_PLACEHOLDER = 190,           /**< This is a generic placeholder For Yet undefined errors */
 } sn_error_codes_e;
 
+typedef enum
+{
+    SN_SANITIZE_OFF = 0,                 /**< Blocks are never cleared */
+    SN_SANITIZE_ON_FREE = 1,             /**< Blocks are zeroed when freed (the default with SN_CONFIG_SANITIZE_MEMORY_ON_FREE) */
+    SN_SANITIZE_ON_ALLOC = 2,            /**< Blocks are zeroed before they are handed out */
+    SN_SANITIZE_ALWAYS = 3,              /**< Both of the above */
+} sn_sanitize_mode_e;
+
 typedef uint64_t sn_tid_t;
 typedef uintptr_t sn_mem_address_t;
 
@@ -211,12 +223,241 @@ SN_PUB_API_OPEN void* sn_realloc(void* ptr, size_t new_size);
  */
 SN_PUB_API_OPEN void* sn_malloc_pre_initialized(size_t size, uint8_t initial_byte_value);
 
+#define SN_CACHE_LINE_SIZE 64
+
+/**
+ * @brief Allocates memory at a given alignment and tracks it for cleanup at program exit.
+ * @param alignment A power of two
+ * @param size The size of the memory block to allocate.
+ * @return Pointer to the allocated memory, or NULL on failure (SN_ERR_BAD_ALIGNMENT if alignment is not a power of two).
+ * @note sn_realloc keeps the alignment, the block is always freed with sn_free
+ * @note These blocks never carry an inline header, lookups on them always go through the registry
+ */
+SN_PUB_API_OPEN void* sn_aligned_alloc(size_t alignment, size_t size);
+
+/**
+ * @brief sn_aligned_alloc to SN_CACHE_LINE_SIZE, so the block shares no cache line with anything else at its start
+ * @param size The size of the memory block to allocate.
+ * @return Pointer to the allocated memory, or NULL on failure.
+ */
+SN_PUB_API_OPEN void* sn_malloc_cacheline(size_t size);
+
+/**
+ * @brief sn_aligned_alloc to the system page size
+ * @param size The size of the memory block to allocate (not rounded up to whole pages).
+ * @return Pointer to the allocated memory, or NULL on failure.
+ */
+SN_PUB_API_OPEN void* sn_malloc_pages(size_t size);
+
 /**
 * @brief Frees a tracked memory block.
 * @param ptr Pointer to the memory block.
 */
 SN_PUB_API_OPEN void sn_free(void* const ptr);
 
+/**
+ * @brief Frees a tracked memory block the caller knows the size of (C++ sized delete, allocators that keep sizes)
+ * @param ptr Pointer to the memory block.
+ * @param size The size it was allocated or last reallocated with
+ * @note If size does not match the block SN_ERR_BAD_SIZE is set, a mismatched free is a bug, the block is still freed
+ */
+SN_PUB_API_OPEN void sn_free_sized(void* const ptr, size_t size);
+
+/**
+ * @brief Allocates count blocks in one go, out[i] gets a block of sizes[i] bytes
+ * The alloc limit is checked once for the whole batch and the registry is locked once per group of blocks
+ * instead of once per block, so this is much cheaper than count sn_malloc calls
+ * @param count Number of blocks
+ * @param sizes count sizes, none of them zero
+ * @param out Receives count pointers, each freed with sn_free or sn_free_batch
+ * @return SN_TRUE if every block was allocated, SN_FALSE (and nothing allocated) on failure
+ * @note Blocks at or over the sn_set_mmap_threshold are mapped as with sn_malloc, the rest come straight from the backend,
+ * never rounded up to a size class or taken from a thread cache
+ */
+SN_PUB_API_OPEN SN_BOOL sn_malloc_batch(size_t count, const size_t* sizes, void** out);
+
+/**
+ * @brief Frees count tracked blocks in one go
+ * @param ptrs The blocks, from any mix of the allocation functions
+ * @param count Number of pointers
+ * @note A NULL, untracked or repeated pointer is skipped and the rest are still freed,
+ * the last error is then set to SN_ERR_NULL_PTR or SN_ERR_NO_ADDER_FOUND
+ */
+SN_PUB_API_OPEN void sn_free_batch(void* const* ptrs, size_t count);
+
+typedef struct sn_arena_s sn_arena_t;
+
+/**
+ * @brief Creates a bump allocated region backed by a single tracked block
+ * The arena counts towards memory usage and the alloc limit as one block of about capacity bytes
+ * @param capacity How many bytes sub allocations can take in total (including alignment padding), rounded up to 16
+ * @return The arena, or NULL on failure (the error is the one sn_malloc produced)
+ */
+SN_PUB_API_OPEN sn_arena_t* sn_arena_create(size_t capacity);
+
+/**
+ * @brief Carves a sub allocation out of an arena
+ * @param arena An arena from sn_arena_create
+ * @param size The size of the sub allocation
+ * @return Pointer aligned for any fundamental type, or NULL with SN_ERR_ARENA_FULL if it does not fit
+ * @note Sub allocations are not tracked blocks, they can't be sn_free'd and go away with the arena
+ * (sn_find_containing_block on one finds the arena's block)
+ * @note Safe to call from several threads on the same arena
+ */
+SN_PUB_API_OPEN void* sn_arena_alloc(sn_arena_t* arena, size_t size);
+
+/**
+ * @brief Drops every sub allocation at once so the arena can be reused
+ * @param arena An arena from sn_arena_create
+ * @warning Must not race with sn_arena_alloc on the same arena
+ */
+SN_PUB_API_OPEN void sn_arena_reset(sn_arena_t* arena);
+
+/**
+ * @brief Frees the arena and every sub allocation in it
+ * @param arena An arena from sn_arena_create
+ */
+SN_PUB_API_OPEN void sn_arena_destroy(sn_arena_t* arena);
+
+typedef struct sn_pool_s sn_pool_t;
+
+/**
+ * @brief Creates a pool of fixed size objects carved out of tracked chunks
+ * Chunks are plain tracked blocks, they count towards memory usage (thread, tag and total) and the alloc limit
+ * @param object_size Size of every object, rounded up to a multiple of 16
+ * @param objects_per_chunk How many objects each chunk holds, the pool grows a chunk at a time
+ * @return The pool, or NULL on failure
+ * @note No chunk is allocated until the first sn_pool_alloc
+ */
+SN_PUB_API_OPEN sn_pool_t* sn_pool_create(size_t object_size, size_t objects_per_chunk);
+
+/**
+ * @brief Takes an object from a pool
+ * @param pool A pool from sn_pool_create
+ * @return Pointer aligned for any fundamental type, or NULL if a new chunk was needed and could not be allocated
+ * @note Objects are not tracked blocks, they can't be sn_free'd and go away with the pool
+ * @note Safe to call from several threads on the same pool
+ */
+SN_PUB_API_OPEN void* sn_pool_alloc(sn_pool_t* pool);
+
+/**
+ * @brief Gives an object back to its pool
+ * @param pool The pool ptr came from
+ * @param ptr An object from sn_pool_alloc on this pool
+ * @warning ptr is not checked against the pool, that would cost a lookup, giving back a foreign or freed object corrupts the pool
+ */
+SN_PUB_API_OPEN void sn_pool_free(sn_pool_t* pool, void* ptr);
+
+/**
+ * @brief Frees the pool, its chunks and every object in them
+ * @param pool A pool from sn_pool_create
+ */
+SN_PUB_API_OPEN void sn_pool_destroy(sn_pool_t* pool);
+
+typedef struct sn_pool_usage_s
+{
+    size_t object_size;                   // Size of every object after rounding
+    size_t chunks;                        // Chunks allocated so far
+    size_t capacity;                      // Objects the chunks can hold
+    size_t live;                          // Objects currently handed out
+    size_t bytes;                         // Bytes the chunks take, what the pool counts for in memory usage
+} sn_pool_usage_t;
+
+/**
+ * @brief Queries how full a pool is
+ * @param pool A pool from sn_pool_create
+ * @param out Where to write the counters
+ * @return SN_FALSE if pool or out is null or pool is not a pool
+ */
+SN_PUB_API_OPEN SN_BOOL sn_query_pool_usage(sn_pool_t* pool, sn_pool_usage_t* out);
+
+#define SN_MAINTENANCE_DEFAULT_PERIOD_MS 100 // Time between maintenance passes when sn_maintenance_start is given 0
+
+/**
+ * @brief Starts the maintenance thread, every period_ms it runs one sn_maintenance_run_once pass
+ * @param period_ms Time between passes in milliseconds, 0 picks SN_MAINTENANCE_DEFAULT_PERIOD_MS
+ * @return SN_FALSE with SN_ERR_SYS_FAIL if the thread could not be started (always in builds without SN_CONFIG_ENABLE_MUTEX)
+ * @note If it is already running only the period changes
+ * @note Without it the fast cache is only filled by sn_request_to_fast_cache and sn_maintenance_run_once
+ */
+SN_PUB_API_OPEN SN_BOOL sn_maintenance_start(uint32_t period_ms);
+
+/**
+ * @brief Stops the maintenance thread and waits for it to exit, does nothing if it is not running
+ * @note The library stops it on its own when it shuts down
+ */
+SN_PUB_API_OPEN void sn_maintenance_stop();
+
+/**
+ * @brief Makes the maintenance thread skip its passes until sn_maintenance_resume (it keeps running)
+ */
+SN_PUB_API_OPEN void sn_maintenance_pause();
+
+/**
+ * @brief Lets a paused maintenance thread run its passes again
+ */
+SN_PUB_API_OPEN void sn_maintenance_resume();
+
+/**
+ * @brief Runs one maintenance pass on the calling thread
+ * A pass promotes hot blocks into the fast cache, hands idle threads' alloc limit budget back
+ * and samples memory usage for sn_query_maintenance_stats
+ * @note This is the way to get maintenance done when there is no maintenance thread
+ */
+SN_PUB_API_OPEN void sn_maintenance_run_once();
+
+typedef struct sn_maintenance_stats_s
+{
+    size_t passes;                        // Passes run so far (by the thread and sn_maintenance_run_once)
+    size_t blocks_scanned;                // Blocks the last pass looked at
+    size_t sampled_usage;                 // Memory usage the last pass saw
+    size_t peak_sampled_usage;            // The highest sampled_usage has ever been
+    SN_BOOL running;                      // Whether the maintenance thread is running
+    SN_BOOL paused;                       // Whether it is paused
+} sn_maintenance_stats_t;
+
+/**
+ * @brief Queries what maintenance has done
+ * @param out Where to write the counters
+ * @return SN_FALSE if out is null
+ */
+SN_PUB_API_OPEN SN_BOOL sn_query_maintenance_stats(sn_maintenance_stats_t* out);
+
+typedef struct sn_stats_s
+{
+    size_t cache_hits;                    // Lookups the fast cache answered
+    size_t cache_misses;                  // Lookups the fast cache was asked and could not answer
+    size_t cache_evictions;               // Blocks pushed out of the fast cache to make room for hotter ones
+    size_t cache_pins;                    // Successful sn_request_to_fast_cache calls
+    size_t cache_slots;                   // Size of the fast cache (see sn_set_fast_cache_size)
+
+    size_t registry_blocks;               // Blocks tracked right now
+    size_t registry_bytes;                // Bytes in them
+
+    size_t lookups_header;                // Lookups answered by an inline block header (see sn_do_inline_headers)
+    size_t lookups_thread_cache;          // Lookups answered by the calling thread's own lookup cache
+    size_t lookups_cache;                 // Lookups answered by the fast cache
+    size_t lookups_index;                 // Lookups that went to the registry's index
+    size_t lookups_scan;                  // Lookups that had to walk the registry block by block
+    double avg_scan_length;               // Blocks such a walk looked at on average
+
+    size_t lock_acquisitions;             // Internal lock acquisitions
+    size_t lock_contended;                // Of those, the ones that had to wait for another thread
+
+    size_t peak_bytes;                    // The most bytes seen tracked at once
+    size_t peak_blocks;                   // The most blocks seen tracked at once
+} sn_stats_t;
+
+/**
+ * @brief Collects the library's cache, lookup and lock counters
+ * Counters are kept per thread and summed here, so they cost next to nothing to keep
+ * They count from startup and are never reset, diff two calls to look at a stretch of time
+ * @param out Where to write them
+ * @return SN_FALSE if out is null
+ * @note The peaks are sampled, by this call and every maintenance pass (see sn_maintenance_start), not on every allocation
+ */
+SN_PUB_API_OPEN SN_BOOL sn_get_stats(sn_stats_t* out);
+
 /**
  * @brief Registers a memory block for tracking.
  * @param ptr Pointer to the memory block.
@@ -242,6 +483,15 @@ SN_PUB_API_OPEN void* sn_register_size(void* ptr, size_t size);
  */
 SN_PUB_API_OPEN size_t sn_query_size(void* const ptr);
 
+/**
+ * @brief Queries how big a tracked block can grow before sn_realloc has to move it
+ * sn_realloc within this size only updates the bookkeeping, the allocator is never called
+ * @param ptr Pointer to the memory block.
+ * @return The usable size (never less than sn_query_size), or 0 on failure.
+ * @note Only the first sn_query_size bytes count towards memory usage and the alloc limit
+ */
+SN_PUB_API_OPEN size_t sn_query_usable_size(void* const ptr);
+
 /**
 * @brief Queries the thread ID associated with a memory block.
 * @param ptr Pointer to the memory block.
@@ -256,6 +506,15 @@ SN_PUB_API_OPEN sn_tid_t sn_query_tid(void* const ptr);
  */
 SN_PUB_API_OPEN SN_FLAG sn_is_tracked_block(const void* const ptr);
 
+/**
+ * @brief Finds the tracked block an address points into (interior pointers included)
+ * @param addr Any address
+ * @param out_offset If not null receives how far into the block addr is
+ * @return A pointer to the start of the owning block, or NULL if no tracked block contains addr
+ * @note This is a O(log n) lookup so it is fine to use in bounds checks and crash handlers
+ */
+SN_PUB_API_OPEN void* sn_find_containing_block(const void* addr, size_t* out_offset);
+
 /**
  * @brief set's a numerical id for the memory block
  * @param id An integer ID for the block
@@ -273,6 +532,8 @@ SN_PUB_API_OPEN uint16_t sn_get_block_id(void* block);
  * @brief query by id to get a pointer to block of tracked memory
  * @param id An id for a block of tracked memory
  * @return A pointer to the block of tracked memory
+ * @note If more than one block was given the same id the first one to take it wins, when it goes another holder takes over
+ * @note This is a lock free table lookup so it is safe to call on hot paths
  */
 SN_PUB_API_OPEN void* sn_query_block_id(uint16_t id);
 
@@ -316,14 +577,24 @@ SN_PUB_API_OPEN void sn_reset_last_error();
 SN_PUB_API_OPEN void sn_do_auto_free_at_exit(SN_FLAG val);
 
 /**
- * @brief Adds the metadata associated with this block of memory to the fast cache
+ * @brief Disables/enables tearing the library down when it is unloaded
+ * @param val If 0 the library, and every block still tracked, stays up until the OS takes the process back
+ * @note On by default, turn it off when destructors that run after the library's own still use or free tracked blocks
+ * @note safetynet.hpp turns it off in a program that defines SN_CPP_REPLACE_GLOBAL_NEW
+ */
+SN_PUB_API_OPEN void sn_do_teardown_at_exit(SN_FLAG val);
+
+/**
+ * @brief Pins the metadata associated with this block of memory in the fast cache
+ * A pinned block is never evicted to make room for a hotter one, it stays until it is freed or the cache is cleared
  * @param ptr A pointer to a Tracked block memory
  * @return Returns 1 if successfully added to fast cash 0 if it did not
+ * (the cache is locked or off, or every slot its address maps to is already pinned)
  */
 SN_PUB_API_OPEN SN_FLAG sn_request_to_fast_cache(const void* ptr);
 
 /**
- * @brief Disables automatic fast caching of tracking metadata But the fast cash is still Queryed
+ * @brief Freezes the fast cache, nothing is promoted into or evicted from it (freeing a block still drops it) But the fast cash is still Queryed
  */
 SN_PUB_API_OPEN void sn_lock_fast_cache();
 
@@ -340,10 +611,44 @@ SN_PUB_API_OPEN void sn_unlock_fast_cache();
 SN_PUB_API_OPEN void sn_do_fast_caching(SN_FLAG val);
 
 /**
- * @brief Clears out the fast cache
+ * @brief Clears out the fast cache (pinned blocks included)
  */
 SN_PUB_API_OPEN void sn_fast_cache_clear();
 
+/**
+ * @brief Resizes the fast cache, it starts out holding SN_CONFIG_FAST_CACHE_SLOTS blocks
+ * The cache is set associative, a block can only go in the few slots its address maps to
+ * and the least recently hit unpinned one makes room for it
+ * @param slots How many blocks it should hold, rounded up to a power of two (at least 4)
+ * @return The new size or 0 on failure (the old cache is kept)
+ * @note The cache starts out empty again
+ */
+SN_PUB_API_OPEN size_t sn_set_fast_cache_size(size_t slots);
+
+/**
+ * @brief Disables/enables the inline block header mode
+ * While on, new blocks carry a small header in front of the user pointer that points back at
+ * their tracking metadata so sn_free and the metadata queries don't have to search the registry
+ * @param val Is set to 1 enables it if set to 0 disables it
+ * @note This system is off by default and is a no-op if built without SN_CONFIG_ENABLE_INLINE_HEADER
+ * @note Blocks keep the mode they were allocated with, foreign blocks from sn_register_size always use the registry
+ * @warning While on, pointers handed to the library are probed for a header before the registry is searched,
+ * a double free of a block whose memory libc already gave back to the OS can fault instead of reporting an error
+ */
+SN_PUB_API_OPEN void sn_do_inline_headers(SN_FLAG val);
+
+/**
+ * @brief Disables/enables the per thread cache of freed small blocks
+ * While on, blocks of 256 bytes or less from sn_malloc are rounded up to a size class and when freed
+ * are kept by the freeing thread for its next sn_malloc of that class instead of going back to libc
+ * @param val Is set to 1 enables it if set to 0 disables it
+ * @note This system is on by default and is a no-op if built without SN_CONFIG_ENABLE_THREAD_CACHE
+ * @note Always off in libsafetynet_preload.so, where the freeing thread keeping blocks would hide double frees from libc
+ * @note A cached block is untracked like any freed block, queries and a second sn_free on it fail with SN_ERR_NO_ADDER_FOUND
+ * until sn_malloc hands it out again, a thread's cache is released when it exits
+ */
+SN_PUB_API_OPEN void sn_do_thread_cache(SN_FLAG val);
+
 
 #ifdef __SN_WIP_CALLS__
 
@@ -392,19 +697,169 @@ SN_PUB_API_OPEN void* sn_mount_file_to_ram(const char* file);
  */
 SN_PUB_API_OPEN void sn_set_alloc_limit(size_t limit);
 
+/**
+ * @brief Where tracked memory comes from, every function gets ctx as its first argument
+ * calloc_fn may be NULL (malloc_fn plus a memset is used), as may usable_size_fn (blocks then have no slack to grow into),
+ * the others are required
+ */
+typedef struct sn_backend_ops_s
+{
+    void* (*malloc_fn)(void* ctx, size_t size);
+    void* (*calloc_fn)(void* ctx, size_t num, size_t size);
+    void* (*realloc_fn)(void* ctx, void* ptr, size_t new_size);
+    void  (*free_fn)(void* ctx, void* ptr);
+    size_t (*usable_size_fn)(void* ctx, void* ptr); // Bytes really usable at ptr, like malloc_usable_size
+    void* ctx;
+} sn_backend_ops_t;
+
+/**
+ * @brief Sets the allocator new tracked blocks come from (sn_malloc, sn_calloc, sn_malloc_batch)
+ * Blocks that already exist keep going back to the backend that allocated them, so this is safe to call any time
+ * @param ops The backend, copied, or NULL to go back to libc
+ * @return SN_TRUE on success, SN_FALSE with SN_ERR_NULL_PTR if a required function is missing
+ * or SN_ERR_BACKEND_LIMIT once 7 distinct backends have been installed over the life of the process
+ * @note Aligned and mapped blocks (sn_aligned_alloc, sn_set_mmap_threshold) do not go through the backend
+ */
+SN_PUB_API_OPEN SN_BOOL sn_set_backend_allocator(const sn_backend_ops_t* ops);
+
+/**
+ * @brief Sets the allocator the registry's bookkeeping nodes are carved from, separate from the one for blocks
+ * Takes effect the next time the registry needs a new page of nodes
+ * @param ops The backend, copied, or NULL to go back to libc
+ * @return Same as sn_set_backend_allocator
+ */
+SN_PUB_API_OPEN SN_BOOL sn_set_node_backend_allocator(const sn_backend_ops_t* ops);
+
+/**
+ * @brief The reference backend everything starts on, plain libc malloc/calloc/realloc/free
+ * Handy as the fallback of a backend that only wants to wrap or count
+ */
+SN_PUB_API_OPEN const sn_backend_ops_t* sn_get_libc_backend_allocator();
+
+/**
+ * @brief Sets when tracked blocks get zeroed
+ * Big blocks are cleared with non temporal stores and, when they came from libc, have their whole pages
+ * dropped (MADV_DONTNEED) instead of written, so sanitizing them costs far less than a memset
+ * @param mode When to clear
+ * @param max_size Blocks bigger than this are left alone, 0 to clear blocks of any size
+ * @note Blocks from sn_set_mmap_threshold are never cleared on free, unmapping already hands zero pages back to the OS
+ */
+SN_PUB_API_OPEN void sn_set_sanitize_policy(sn_sanitize_mode_e mode, size_t max_size);
+
+/**
+ * @brief Blocks of at least threshold bytes from sn_malloc/sn_calloc/sn_malloc_batch get their own mapping straight from the OS
+ * sn_realloc then moves/resizes the pages (mremap) instead of copying and sn_free unmaps them without the sanitize memset
+ * @param threshold The size in bytes, If given zero no block is mapped (the default)
+ * @note Every mapped block takes whole pages, keep the threshold well above the page size
+ */
+SN_PUB_API_OPEN void sn_set_mmap_threshold(size_t threshold);
+
+/**
+ * @brief Disables/enables asking for transparent huge pages (MADV_HUGEPAGE) on mapped blocks
+ * @param val Is set to 1 enables it if set to 0 disables it
+ * @note This is off by default and a no-op where the platform has no such advice
+ */
+SN_PUB_API_OPEN void sn_do_huge_pages(SN_FLAG val);
+
 /**
  * @brief Queries memory usage for a specific thread.
  * @param tid The thread ID.
  * @return Total memory used by the thread, or 0 if no memory is tracked for this thread.
+ * @note Blocks stay charged to the thread that allocated them even if another thread frees them
  */
 SN_PUB_API_OPEN size_t sn_query_thread_memory_usage(sn_tid_t tid);
 
+typedef struct sn_thread_memory_usage_s
+{
+    sn_tid_t tid;                         // The thread these counters belong to
+    size_t bytes;                         // Bytes currently tracked for this thread
+    size_t blocks;                        // Blocks currently tracked for this thread
+    size_t peak_bytes;                    // The highest bytes has ever been
+} sn_thread_memory_usage_t;
+
+/**
+ * @brief Fills out with the usage counters of every thread that has ever allocated a tracked block
+ * @param out Array to fill (may be null if max_count is 0)
+ * @param max_count How many elements out can hold
+ * @return The number of known threads, if this is bigger than max_count only max_count were written
+ */
+SN_PUB_API_OPEN size_t sn_query_all_thread_memory_usage(sn_thread_memory_usage_t* out, size_t max_count);
+
 /**
  * @brief Queries total memory usage across all threads.
  * @return Total memory currently tracked.
+ * @note This includes foreign blocks from sn_register_size, and so does the sn_set_alloc_limit check
  */
 SN_PUB_API_OPEN size_t sn_query_total_memory_usage();
 
+#define SN_TAG_MAX_DEPTH 8   // How deep the tag tree may get (a root tag is depth 1)
+#define SN_TAG_NAME_MAX 32   // Names are cut to SN_TAG_NAME_MAX - 1 characters
+
+typedef struct tag_usage_node_s sn_tag_t;
+
+/**
+ * @brief Finds or creates the tag called name under parent
+ * @param name Name of the tag, two tags under the same parent with the same name are the same tag
+ * @param parent The parent tag or null for a root tag
+ * @return The tag or null if it would be deeper than SN_TAG_MAX_DEPTH (SN_ERR_TAG_DEPTH)
+ * @note Tags live until the library shuts down
+ */
+SN_PUB_API_OPEN sn_tag_t* sn_tag_create(const char* name, sn_tag_t* parent);
+
+/**
+ * @brief Makes tag the current tag of the calling thread, every block this thread allocates is charged to it until it is popped
+ * @param tag The tag to push
+ * @return SN_FALSE if tag is null or the thread already has SN_TAG_MAX_DEPTH tags pushed (SN_ERR_TAG_DEPTH)
+ * @note Bytes charged to a tag count against it and all its ancestors
+ */
+SN_PUB_API_OPEN SN_BOOL sn_tag_push(sn_tag_t* tag);
+
+/**
+ * @brief Goes back to the tag that was current before the last sn_tag_push on this thread
+ */
+SN_PUB_API_OPEN void sn_tag_pop();
+
+/**
+ * @brief Gets the current tag of the calling thread
+ * @return The tag or null if none is pushed
+ */
+SN_PUB_API_OPEN sn_tag_t* sn_tag_current();
+
+/**
+ * @brief Caps how many bytes may be charged to tag and its descendants
+ * @param tag The tag to limit
+ * @param limit The cap in bytes, 0 removes it
+ * @note An allocation that would pass the cap of its tag or any ancestor fails with SN_ERR_ALLOC_LIMIT_HIT
+ */
+SN_PUB_API_OPEN void sn_tag_set_limit(sn_tag_t* tag, size_t limit);
+
+typedef struct sn_tag_usage_s
+{
+    sn_tag_t* tag;                        // The tag these counters belong to
+    sn_tag_t* parent;                     // Its parent or null
+    const char* name;                     // Its name (lives as long as the tag)
+    size_t bytes;                         // Bytes charged to the tag and its descendants
+    size_t blocks;                        // Blocks charged to the tag and its descendants
+    size_t peak_bytes;                    // The highest bytes has ever been
+    size_t limit;                         // The cap set with sn_tag_set_limit or 0
+} sn_tag_usage_t;
+
+/**
+ * @brief Queries the counters of a single tag
+ * @param tag The tag
+ * @param out Where to write them
+ * @return SN_FALSE if tag or out is null
+ */
+SN_PUB_API_OPEN SN_BOOL sn_query_tag_usage(sn_tag_t* tag, sn_tag_usage_t* out);
+
+/**
+ * @brief Fills out with the counters of every tag ever created
+ * @param out Array to fill (may be null if max_count is 0)
+ * @param max_count How many elements out can hold
+ * @return The number of tags, if this is bigger than max_count only max_count were written
+ */
+SN_PUB_API_OPEN size_t sn_query_all_tag_usage(sn_tag_usage_t* out, size_t max_count);
+
 /**
  * @brief Returns the number of elements within an array based off of the block_size
  * @param ptr A pointer to a tracked block of memory
@@ -421,6 +876,14 @@ SN_FORCE_INLINE size_t sn_query_size_in_block_size(void* ptr, size_t block_size)
 
 typedef sn_mem_metadata_t* (*sn_metadata_for_each_worker_f)(sn_mem_metadata_t* ctx, size_t index, void* generic_arg);
 
+/**
+ * @brief Walks the metadata of every tracked block until worker returns non null
+ * @param worker Runs with no lock held, so it may use any of the API, blocks freed or moved before their turn are skipped
+ * ctx is a copy taken when the walk started, it stays readable for the call even if the block is freed meanwhile
+ * @param generic_arg Passed through to worker
+ * @return What worker returned to stop the walk, null if it never did
+ * @note A returned ctx comes back as the block's own metadata, valid only as long as the block stays allocated
+ */
 SN_PUB_API_OPEN sn_mem_metadata_t* sn_mem_metadata_for_each(sn_metadata_for_each_worker_f worker, void* generic_arg);
 
 #endif
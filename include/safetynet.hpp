@@ -0,0 +1,281 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+/*
+ * C++ side of libsafetynet
+ * Everything here is a thin inline layer over the C API, a tracked block is a tracked block whichever header made it
+ *
+ * safetynet::memory_resource   std::pmr::memory_resource handing out tracked blocks
+ * safetynet::allocator<T>      stateless STL allocator, std::vector<int, safetynet::allocator<int>>
+ * safetynet::unique_ptr<T>     owning handles, safetynet::make_unique<T>(...) / safetynet::make_block(size)
+ *
+ * Define SN_CPP_REPLACE_GLOBAL_NEW in exactly one translation unit before including this
+ * to route every operator new/delete of the program through the tracker
+ * (that also turns off the exit time teardown, see sn_do_teardown_at_exit)
+ */
+
+#pragma once
+#ifndef SAFETYNET_HPP
+#define SAFETYNET_HPP
+
+#include "libsafetynet.h"
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace safetynet
+{
+#ifndef SN_ENABLE_CPP_NAMESPACE
+    // The C API lives in the global namespace unless SN_ENABLE_CPP_NAMESPACE puts it in this one
+    using ::sn_malloc;
+    using ::sn_aligned_alloc;
+    using ::sn_free;
+    using ::sn_free_sized;
+#endif
+
+    namespace detail
+    {
+        // sn_malloc is aligned for any fundamental type, anything stricter goes through sn_aligned_alloc
+        inline void* allocate(std::size_t size, std::size_t alignment) noexcept
+        {
+            if (size == 0) size = 1;
+            if (alignment <= alignof(std::max_align_t))
+                return sn_malloc(size);
+            return sn_aligned_alloc(alignment, size);
+        }
+
+        inline void deallocate(void* ptr, std::size_t size) noexcept
+        {
+            sn_free_sized(ptr, size ? size : 1);
+        }
+    }
+
+    /**
+     * @brief std::pmr::memory_resource backed by sn_malloc/sn_aligned_alloc and sn_free_sized
+     * @note Stateless, every instance is equal to every other, get_memory_resource() returns a shared one
+     */
+    class memory_resource final : public std::pmr::memory_resource
+    {
+    protected:
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            void* ptr = detail::allocate(bytes, alignment);
+            if (!ptr) throw std::bad_alloc();
+            return ptr;
+        }
+
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t) override
+        {
+            detail::deallocate(ptr, bytes);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return dynamic_cast<const memory_resource*>(&other) != nullptr;
+        }
+    };
+
+    inline memory_resource* get_memory_resource() noexcept
+    {
+        static memory_resource resource;
+        return &resource;
+    }
+
+    /**
+     * @brief Stateless STL allocator handing out tracked blocks
+     * @note Empty, so containers using it are the same size as with std::allocator
+     */
+    template<class T>
+    struct allocator
+    {
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        constexpr allocator() noexcept = default;
+
+        template<class U>
+        constexpr allocator(const allocator<U>&) noexcept {}
+
+        [[nodiscard]] T* allocate(std::size_t count)
+        {
+            if (count > std::numeric_limits<std::size_t>::max() / sizeof(T))
+                throw std::bad_array_new_length();
+
+            void* ptr = detail::allocate(count * sizeof(T), alignof(T));
+            if (!ptr) throw std::bad_alloc();
+            return static_cast<T*>(ptr);
+        }
+
+        void deallocate(T* ptr, std::size_t count) noexcept
+        {
+            detail::deallocate(ptr, count * sizeof(T));
+        }
+
+        template<class U>
+        constexpr bool operator==(const allocator<U>&) const noexcept { return true; }
+
+        template<class U>
+        constexpr bool operator!=(const allocator<U>&) const noexcept { return false; }
+    };
+
+    /**
+     * @brief Destroys and frees an object made by make_unique
+     */
+    template<class T>
+    struct deleter
+    {
+        constexpr deleter() noexcept = default;
+
+        template<class U, class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+        constexpr deleter(const deleter<U>&) noexcept {}
+
+        void operator()(T* ptr) const noexcept
+        {
+            // Through a base pointer sizeof(T) is not the block size, only the exact type may use the sized free
+            if constexpr (std::has_virtual_destructor_v<T>)
+            {
+                void* block = dynamic_cast<void*>(ptr);
+                ptr->~T();
+                sn_free(block);
+            }
+            else
+            {
+                ptr->~T();
+                detail::deallocate(ptr, sizeof(T));
+            }
+        }
+    };
+
+    /**
+     * @brief Frees a raw block made by make_block
+     */
+    struct block_deleter
+    {
+        void operator()(void* ptr) const noexcept
+        {
+            sn_free(ptr);
+        }
+    };
+
+    template<class T>
+    using unique_ptr = std::unique_ptr<T, deleter<T>>;
+
+    using unique_block = std::unique_ptr<void, block_deleter>;
+
+    /**
+     * @brief Constructs a T in a tracked block
+     * @throw std::bad_alloc if the block can't be allocated, whatever T's constructor throws
+     */
+    template<class T, class... Args>
+    unique_ptr<T> make_unique(Args&&... args)
+    {
+        static_assert(!std::is_array_v<T>, "safetynet::make_unique is for single objects, use a container with safetynet::allocator");
+
+        void* ptr = detail::allocate(sizeof(T), alignof(T));
+        if (!ptr) throw std::bad_alloc();
+
+        try
+        {
+            return unique_ptr<T>(::new (ptr) T(std::forward<Args>(args)...));
+        }
+        catch (...)
+        {
+            detail::deallocate(ptr, sizeof(T));
+            throw;
+        }
+    }
+
+    /**
+     * @brief Takes a raw tracked block of size bytes
+     * @return The block, empty if it could not be allocated (sn_get_last_error says why)
+     */
+    inline unique_block make_block(std::size_t size) noexcept
+    {
+        return unique_block(sn_malloc(size));
+    }
+}
+
+#ifdef SN_CPP_REPLACE_GLOBAL_NEW
+
+// These are the replacements the standard allows, so they are defined (not inline) in the one file that opts in
+
+namespace safetynet::detail
+{
+    static void* new_or_throw(std::size_t size, std::size_t alignment)
+    {
+        for (;;)
+        {
+            if (void* ptr = allocate(size, alignment)) return ptr;
+
+            std::new_handler handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    static void* new_or_null(std::size_t size, std::size_t alignment) noexcept
+    {
+        try
+        {
+            return new_or_throw(size, alignment);
+        }
+        catch (...)
+        {
+            return nullptr;
+        }
+    }
+
+    // Every C++ object is a tracked block now and other shared objects' destructors run after the library's own,
+    // an exit time teardown would free objects they still use, so the library stays up and the OS takes it all back
+    [[maybe_unused]] static const bool keep_library_up = (sn_do_teardown_at_exit(SN_FLAG_UNSET), true);
+}
+
+void* operator new(std::size_t size) { return safetynet::detail::new_or_throw(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size) { return safetynet::detail::new_or_throw(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return safetynet::detail::new_or_null(size, alignof(std::max_align_t)); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return safetynet::detail::new_or_null(size, alignof(std::max_align_t)); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return safetynet::detail::new_or_throw(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return safetynet::detail::new_or_throw(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return safetynet::detail::new_or_null(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return safetynet::detail::new_or_null(size, static_cast<std::size_t>(alignment)); }
+
+// Unsized deletes have to look the block up, the sized ones let the tracker check the size it was given
+void operator delete(void* ptr) noexcept { if (ptr) safetynet::sn_free(ptr); }
+void operator delete[](void* ptr) noexcept { if (ptr) safetynet::sn_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { if (ptr) safetynet::sn_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { if (ptr) safetynet::sn_free(ptr); }
+void operator delete(void* ptr, std::size_t size) noexcept { if (ptr) safetynet::detail::deallocate(ptr, size); }
+void operator delete[](void* ptr, std::size_t size) noexcept { if (ptr) safetynet::detail::deallocate(ptr, size); }
+void operator delete(void* ptr, std::align_val_t) noexcept { if (ptr) safetynet::sn_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { if (ptr) safetynet::sn_free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { if (ptr) safetynet::sn_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { if (ptr) safetynet::sn_free(ptr); }
+void operator delete(void* ptr, std::size_t size, std::align_val_t) noexcept { if (ptr) safetynet::detail::deallocate(ptr, size); }
+void operator delete[](void* ptr, std::size_t size, std::align_val_t) noexcept { if (ptr) safetynet::detail::deallocate(ptr, size); }
+
+#endif //SN_CPP_REPLACE_GLOBAL_NEW
+
+#endif //SAFETYNET_HPP
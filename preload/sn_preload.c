@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+/*
+ * LD_PRELOAD interposer, makes every malloc/calloc/realloc/free and every aligned allocator in the process a tracked block
+ * The library is built into this object a second time with BUILDING_SAFETYNET_PRELOAD so its own plat_malloc
+ * goes straight to glibc (see plat_allocators.c), blocks stay plain glibc chunks since inline headers stay off
+ * so anything libc hands out on its own (allocations from before the constructor ran or made by the tracker itself)
+ * can still be freed through here, those are just passed on untracked
+ *
+ * What it does not do (see README.md too):
+ * - Keep up with glibc, a malloc/free pair is a couple dozen atomics and lock round trips (limit budget, thread usage,
+ *   shard lock, node pool, index and address tree upkeep) where glibc's tcache has none, sn_preload_bench has the numbers
+ * - Survive fork() in a multithreaded program, a tracker lock held by another thread stays held in the child
+ */
+
+#include <errno.h>
+#include <stdint.h>
+
+#include "libsafetynet.h"
+#include "_pri_api.h"
+#include "platform_independent/plat_allocators.h"
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t num, size_t size);
+extern void* __libc_realloc(void* ptr, size_t new_size);
+extern void __libc_free(void* ptr);
+extern void* __libc_memalign(size_t alignment, size_t size);
+
+/*
+ * Depth of tracker calls on this thread, if the tracker itself ends up in malloc (stdio in sn_crash, pthread internals)
+ * that goes to glibc instead of deadlocking on a mutex this thread already holds
+ * The target is built with -ftls-model=initial-exec so touching this never allocates
+ */
+static plat_thread_local size_t preload_depth = 0;
+
+static SN_BOOL sn_preload_pri_enter()
+{
+    // mem_registry is only set once the library constructor ran, the loader and libc start up before that
+    if (preload_depth || !mem_registry) return SN_FALSE;
+    preload_depth++;
+    return SN_TRUE;
+}
+
+static void sn_preload_pri_leave()
+{
+    preload_depth--;
+}
+
+SN_PUB_API_OPEN void* malloc(size_t size)
+{
+    if (!sn_preload_pri_enter()) return __libc_malloc(size);
+
+    // malloc(0) has to hand back something free() takes
+    void* ptr = sn_malloc(size ? size : 1);
+    sn_preload_pri_leave();
+
+    if (!ptr) errno = ENOMEM;
+    return ptr;
+}
+
+SN_PUB_API_OPEN void* calloc(size_t num, size_t size)
+{
+    if (!sn_preload_pri_enter()) return __libc_calloc(num, size);
+
+    void* ptr = (num && size) ? sn_calloc(num, size) : sn_calloc(1, 1);
+    sn_preload_pri_leave();
+
+    if (!ptr) errno = ENOMEM;
+    return ptr;
+}
+
+SN_PUB_API_OPEN void free(void* ptr)
+{
+    if (!ptr) return;
+    if (!sn_preload_pri_enter())
+    {
+        __libc_free(ptr);
+        return;
+    }
+
+    // The lookup decides, not the last error, that one is shared by every thread and costs a lock to reset and read
+    const int saved_errno = errno;
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, ptr);
+    if (entry) sn_pri_free_entry(entry, ptr);
+    sn_preload_pri_leave();
+
+    if (!entry) __libc_free(ptr);
+    errno = saved_errno;
+}
+
+SN_PUB_API_OPEN void* realloc(void* ptr, size_t new_size)
+{
+    if (!ptr) return malloc(new_size);
+    if (!new_size)
+    {
+        free(ptr);
+        return NULL;
+    }
+    if (!sn_preload_pri_enter()) return __libc_realloc(ptr, new_size);
+
+    // sn_realloc finds it again in this thread's lookup cache
+    if (!memman_findEntry(memory_manager, mem_registry, ptr))
+    {
+        sn_preload_pri_leave();
+        return __libc_realloc(ptr, new_size);
+    }
+    void* moved = sn_realloc(ptr, new_size);
+    sn_preload_pri_leave();
+
+    if (!moved) errno = ENOMEM;
+    return moved;
+}
+
+static void* sn_preload_pri_aligned(size_t alignment, size_t size)
+{
+    if (!sn_preload_pri_enter()) return __libc_memalign(alignment, size);
+
+    void* ptr = sn_aligned_alloc(alignment, size ? size : 1);
+    sn_preload_pri_leave();
+    return ptr;
+}
+
+SN_PUB_API_OPEN int posix_memalign(void** memptr, size_t alignment, size_t size)
+{
+    if (!alignment || (alignment & (alignment - 1)) || alignment % sizeof(void*)) return EINVAL;
+
+    void* ptr = sn_preload_pri_aligned(alignment, size);
+    if (!ptr) return ENOMEM;
+    *memptr = ptr;
+    return 0;
+}
+
+// glibc takes any power of two here and does not hold aligned_alloc to size being a multiple of it either
+SN_PUB_API_OPEN void* memalign(size_t alignment, size_t size)
+{
+    if (!alignment || (alignment & (alignment - 1)))
+    {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    void* ptr = sn_preload_pri_aligned(alignment, size);
+    if (!ptr) errno = ENOMEM;
+    return ptr;
+}
+
+SN_PUB_API_OPEN void* aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+SN_PUB_API_OPEN void* valloc(size_t size)
+{
+    return memalign(plat_getPageSize(), size);
+}
+
+SN_PUB_API_OPEN void* pvalloc(size_t size)
+{
+    const size_t page = plat_getPageSize();
+    if (size > SIZE_MAX - page)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return memalign(page, size ? (size + page - 1) & ~(page - 1) : page);
+}
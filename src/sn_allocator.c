@@ -23,40 +23,151 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "sn_block.h"
 #include "../backend_api/include/platform_independent/plat_allocators.h"
 
+static size_t sn_pri_new_block_header_size()
+{
+#ifdef SN_CONFIG_ENABLE_INLINE_HEADER
+    if (memory_manager->use_inline_headers) return SN_BLOCK_HEADER_SIZE;
+#endif
+    return 0;
+}
 
-SN_PUB_API_OPEN void* sn_malloc(size_t size)
+// base is the raw allocation, the caller gets base + header_size (entry->data)
+static linked_list_entry_c sn_pri_track_new_block(void* base, size_t header_size, size_t size, uint8_t flags, uint8_t backend)
 {
-    if (size == 0)
+    void* pr = (uint8_t*)base + header_size;
+    linked_list_entry_c entry = sn_pri_registry_insert(pr, size);
+    entry->flags |= flags;
+    entry->backend = backend;
+
+    if (header_size)
+        sn_block_headerInstall(pr, entry);
+
+    entry->usable = sn_block_queryUsable(entry);
+    return entry;
+}
+
+static SN_BOOL sn_pri_should_map(size_t size)
+{
+    const size_t threshold = memory_manager->mmap_threshold;
+    return threshold && size >= threshold;
+}
+
+// Mapped pages come zeroed and go back to the OS on free, so they are never sanitized
+static linked_list_entry_c sn_pri_map_new_block(size_t size)
+{
+    const size_t header_size = sn_pri_new_block_header_size();
+    if (size > SIZE_MAX - header_size - plat_getPageSize())
     {
         sn_error(SN_ERR_BAD_SIZE, NULL);
     }
 
-    if (!memman_canAllocateBasedOnLimitAndSize(memory_manager, size))
+    const size_t length = sn_block_mappedLength(header_size, size);
+    void* base = plat_map(length);
+
+    if (!base)
     {
-        sn_error(SN_ERR_ALLOC_LIMIT_HIT, NULL);
+        sn_error(SN_ERR_BAD_ALLOC, NULL);
     }
 
-    void* pr = plat_malloc(size);
+    if (memory_manager->use_huge_pages)
+        plat_adviseHugePages(base, length);
+
+    return sn_pri_track_new_block(base, header_size, size, SN_BLOCK_FLAG_MAPPED, PLAT_BACKEND_LIBC);
+}
 
-    if (!pr)
+// size is already reserved against the limit, the caller releases it if this fails
+static void* sn_pri_malloc(size_t size)
+{
+    if (sn_pri_should_map(size))
     {
-        sn_error(SN_ERR_BAD_ALLOC, NULL);
+        linked_list_entry_c entry = sn_pri_map_new_block(size);
+        return entry ? entry->data : NULL;
     }
 
-//The config macro does not fully conform to what we're doing here lol
-#ifdef SN_CONFIG_SANITIZE_MEMORY_ON_FREE
-    memset(pr, 0, size);
+#ifdef SN_CONFIG_ENABLE_THREAD_CACHE
+    const size_t class_size = memory_manager->use_thread_cache ? thread_cache_classSize(size) : 0;
+    if (class_size)
+    {
+        linked_list_entry_c entry = sn_pri_registry_unpark(size);
+        if (entry)
+        {
+            if (memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_ALLOC, size))
+                sn_block_clear(entry->data, size, SN_FALSE);
+            if (entry->flags & SN_BLOCK_FLAG_INLINE_HEADER)
+                sn_block_headerInstall(entry->data, entry);
+            return entry->data;
+        }
+    }
+#else
+    const size_t class_size = 0;
 #endif
-    memory_manager->global_memory_usage += size;
-    linked_list_push(mem_list, pr, size, plat_getTid());
 
-    return pr;
+    const size_t header_size = sn_pri_new_block_header_size();
+    const size_t capacity = class_size ? class_size : size;
+    if (capacity > SIZE_MAX - header_size)
+    {
+        sn_error(SN_ERR_BAD_SIZE, NULL);
+    }
+
+    const uint8_t backend = plat_backend_current(PLAT_BACKEND_FOR_BLOCKS);
+    void* base = plat_backend_malloc(backend, capacity + header_size);
+
+    if (!base)
+    {
+        sn_error(SN_ERR_BAD_ALLOC, NULL);
+    }
+
+    if (memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_ALLOC, capacity))
+        sn_block_clear((uint8_t*)base + header_size, capacity, backend == PLAT_BACKEND_LIBC);
+    return sn_pri_track_new_block(base, header_size, size, class_size ? SN_BLOCK_FLAG_SIZE_CLASS : 0, backend)->data;
+}
+
+SN_PUB_API_OPEN void* sn_malloc(size_t size)
+{
+    if (size == 0)
+    {
+        sn_error(SN_ERR_BAD_SIZE, NULL);
+    }
+
+    if (!mem_registry && !sn_pri_lazy_init())
+        return plat_malloc(size);
+
+    if (!sn_pri_limit_reserve(size, sn_pri_current_tag()))
+    {
+        sn_error(SN_ERR_ALLOC_LIMIT_HIT, NULL);
+    }
+
+    void* ptr = sn_pri_malloc(size);
+    if (!ptr)
+        sn_pri_limit_release(size, sn_pri_current_tag());
+    return ptr;
 }
 
 
 
+void sn_pri_free_entry(linked_list_entry_c entry, void* const ptr)
+{
+    if (memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_FREE, entry->size))
+        sn_block_sanitize(entry);
+    memman_cacheInvalidate(memory_manager, ptr);
+
+    sn_pri_release_block_id(entry);
+
+    if (entry->flags & SN_BLOCK_FLAG_INLINE_HEADER)
+        sn_block_headerClear(ptr); // So a double free can't pass the header check
+
+#ifdef SN_CONFIG_ENABLE_THREAD_CACHE
+    if ((entry->flags & SN_BLOCK_FLAG_SIZE_CLASS) && memory_manager->use_thread_cache && sn_pri_registry_park(entry))
+        return;
+#endif
+    sn_block_release(entry);
+
+    sn_pri_registry_remove(entry);
+}
+
 SN_PUB_API_OPEN void sn_free(void* const ptr)
 {
     if (!ptr)
@@ -64,24 +175,205 @@ SN_PUB_API_OPEN void sn_free(void* const ptr)
         sn_error(SN_ERR_NULL_PTR);
     }
 
-    linked_list_entry_c entry = memman_TryCacheHit(memory_manager, ptr);
-    if (entry == MEMMAN_CACHE_MISS)
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, ptr);
+    if (!entry)
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND);
+    }
+
+    sn_pri_free_entry(entry, ptr);
+}
+
+SN_PUB_API_OPEN void sn_free_sized(void* const ptr, size_t size)
+{
+    if (!ptr)
+    {
+        sn_error(SN_ERR_NULL_PTR);
+    }
+
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, ptr);
+    if (!entry)
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND);
+    }
+
+    if (entry->size != size)
+    {
+        // Reported, but freed all the same, a sized delete can't be retried and leaving it would only leak it
+        sn_set_last_error(SN_ERR_BAD_SIZE);
+    }
+
+    sn_pri_free_entry(entry, ptr);
+}
+
+SN_PUB_API_OPEN SN_BOOL sn_malloc_batch(size_t count, const size_t* sizes, void** out)
+{
+    if (!sizes || !out)
+    {
+        sn_error(SN_ERR_NULL_PTR, SN_FALSE);
+    }
+
+    if (!mem_registry && !sn_pri_lazy_init())
+    {
+        sn_error(SN_ERR_BAD_ALLOC, SN_FALSE);
+    }
+
+    const size_t header_size = sn_pri_new_block_header_size();
+    const size_t map_threshold = memory_manager->mmap_threshold; // Read once so the undo below sees what we did
+    size_t total_size = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!sizes[i] || sizes[i] > SIZE_MAX - header_size - plat_getPageSize() || sizes[i] > SIZE_MAX - total_size)
+        {
+            sn_error(SN_ERR_BAD_SIZE, SN_FALSE);
+        }
+        total_size += sizes[i];
+    }
+
+    if (!sn_pri_limit_reserve(total_size, sn_pri_current_tag()))
+    {
+        sn_error(SN_ERR_ALLOC_LIMIT_HIT, SN_FALSE);
+    }
+
+    // Get all the memory first so a failure has nothing in the registry to undo
+    const uint8_t backend = plat_backend_current(PLAT_BACKEND_FOR_BLOCKS);
+    for (size_t i = 0; i < count; i++)
     {
-        entry = linked_list_getByPtr(mem_list, ptr);
-        if (!entry)
+        const SN_BOOL mapped = map_threshold && sizes[i] >= map_threshold;
+        void* base = mapped
+            ? plat_map(sn_block_mappedLength(header_size, sizes[i]))
+            : plat_backend_malloc(backend, sizes[i] + header_size);
+        if (!base)
         {
-            sn_error(SN_ERR_NO_ADDER_FOUND);
+            while (i > 0)
+            {
+                i--;
+                void* undo = (uint8_t*)out[i] - header_size;
+                if (map_threshold && sizes[i] >= map_threshold)
+                    plat_unmap(undo, sn_block_mappedLength(header_size, sizes[i]));
+                else
+                    plat_backend_free(backend, undo);
+                out[i] = NULL;
+            }
+            sn_pri_limit_release(total_size, sn_pri_current_tag());
+            sn_error(SN_ERR_BAD_ALLOC, SN_FALSE);
         }
+
+        if (mapped && memory_manager->use_huge_pages)
+            plat_adviseHugePages(base, sn_block_mappedLength(header_size, sizes[i]));
+        else if (!mapped && memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_ALLOC, sizes[i]))
+            sn_block_clear((uint8_t*)base + header_size, sizes[i], backend == PLAT_BACKEND_LIBC);
+        out[i] = (uint8_t*)base + header_size;
+    }
+
+    linked_list_entry_c entries[REGISTRY_BATCH_CHUNK];
+    for (size_t base = 0; base < count; base += REGISTRY_BATCH_CHUNK)
+    {
+        const size_t n = count - base < REGISTRY_BATCH_CHUNK ? count - base : REGISTRY_BATCH_CHUNK;
+        sn_pri_registry_insertBatch(out + base, sizes + base, n, entries);
+
+        for (size_t k = 0; k < n; k++)
+        {
+            if (map_threshold && sizes[base + k] >= map_threshold)
+            {
+                entries[k]->flags |= SN_BLOCK_FLAG_MAPPED;
+                entries[k]->backend = PLAT_BACKEND_LIBC;
+            }
+            else
+            {
+                entries[k]->backend = backend;
+            }
+            if (header_size)
+                sn_block_headerInstall(out[base + k], entries[k]);
+            entries[k]->usable = sn_block_queryUsable(entries[k]);
+        }
+    }
+
+    return SN_TRUE;
+}
+
+SN_PUB_API_OPEN void sn_free_batch(void* const* ptrs, size_t count)
+{
+    if (!ptrs)
+    {
+        sn_error(SN_ERR_NULL_PTR);
     }
 
-#ifdef SN_CONFIG_SANITIZE_MEMORY_ON_FREE
-    memset(entry->data, 0, entry->size);
+    sn_error_codes_e err = SN_ERR_OK;
+    linked_list_entry_c entries[REGISTRY_BATCH_CHUNK];
+    for (size_t base = 0; base < count; base += REGISTRY_BATCH_CHUNK)
+    {
+        const size_t n = count - base < REGISTRY_BATCH_CHUNK ? count - base : REGISTRY_BATCH_CHUNK;
+        size_t found = 0;
+
+        for (size_t k = 0; k < n; k++)
+        {
+            void* const ptr = ptrs[base + k];
+            if (!ptr)
+            {
+                err = SN_ERR_NULL_PTR;
+                continue;
+            }
+
+            linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, ptr);
+            if (!entry || (entry->flags & SN_BLOCK_FLAG_BATCH_FREED))
+            {
+                err = SN_ERR_NO_ADDER_FOUND;
+                continue;
+            }
+
+            if (memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_FREE, entry->size))
+                sn_block_sanitize(entry);
+            memman_cacheInvalidate(memory_manager, ptr);
+
+            sn_pri_release_block_id(entry);
+
+            if (entry->flags & SN_BLOCK_FLAG_INLINE_HEADER)
+                sn_block_headerClear(ptr);
+
+#ifdef SN_CONFIG_ENABLE_THREAD_CACHE
+            if ((entry->flags & SN_BLOCK_FLAG_SIZE_CLASS) && memory_manager->use_thread_cache && sn_pri_registry_park(entry))
+                continue;
 #endif
-    memory_manager->global_memory_usage -= entry->size;
-    memman_cacheInvalidate(memory_manager, ptr);
-    plat_free(linked_list_entry_getData(entry));
+            sn_block_release(entry);
+            entry->flags |= SN_BLOCK_FLAG_BATCH_FREED;
+            entries[found++] = entry;
+        }
+
+        sn_pri_registry_removeBatch(entries, found);
+    }
 
-    linked_list_removeEntryByPtr(mem_list, ptr);
+    // Everything valid was freed, report the last bad pointer
+    if (err != SN_ERR_OK)
+    {
+        sn_error(err);
+    }
+}
+
+// total_size is already reserved against the limit, the caller releases it if this fails
+static void* sn_pri_calloc(size_t num, size_t size, size_t total_size)
+{
+    if (sn_pri_should_map(total_size))
+    {
+        linked_list_entry_c entry = sn_pri_map_new_block(total_size);
+        return entry ? entry->data : NULL;
+    }
+
+    const size_t header_size = sn_pri_new_block_header_size();
+    if (total_size > SIZE_MAX - header_size)
+    {
+        sn_error(SN_ERR_BAD_SIZE, NULL);
+    }
+
+    const uint8_t backend = plat_backend_current(PLAT_BACKEND_FOR_BLOCKS);
+    void* base = header_size ? plat_backend_calloc(backend, 1, total_size + header_size) : plat_backend_calloc(backend, num, size);
+
+    if (!base)
+    {
+        sn_error(SN_ERR_BAD_ALLOC, NULL);
+    }
+
+    return sn_pri_track_new_block(base, header_size, total_size, 0, backend)->data;
 }
 
 SN_PUB_API_OPEN void* sn_calloc(size_t num, size_t size)
@@ -91,21 +383,36 @@ SN_PUB_API_OPEN void* sn_calloc(size_t num, size_t size)
         sn_error(SN_ERR_BAD_SIZE, NULL);
     }
 
-    if (!memman_canAllocateBasedOnLimitAndSize(memory_manager, (size * num)))
+    if (num > SIZE_MAX / size)
     {
-        sn_error(SN_ERR_ALLOC_LIMIT_HIT, NULL);
+        sn_error(SN_ERR_BAD_SIZE, NULL);
     }
 
-    void* pr = plat_calloc(num, size);
+    if (!mem_registry && !sn_pri_lazy_init())
+        return plat_calloc(num, size);
 
-    if (!pr)
+    const size_t total_size = size * num;
+
+    if (!sn_pri_limit_reserve(total_size, sn_pri_current_tag()))
     {
-        sn_error(SN_ERR_BAD_ALLOC, NULL);
+        sn_error(SN_ERR_ALLOC_LIMIT_HIT, NULL);
     }
-    memory_manager->global_memory_usage += (size * num);
-    linked_list_push(mem_list, pr, size, plat_getTid());
 
-    return pr;
+    void* ptr = sn_pri_calloc(num, size, total_size);
+    if (!ptr)
+        sn_pri_limit_release(total_size, sn_pri_current_tag());
+    return ptr;
+}
+
+// There is no aligned realloc anywhere, move it by hand
+static void* sn_pri_aligned_realloc(linked_list_entry_c entry, size_t new_size)
+{
+    void* new_base = plat_aligned_alloc(sn_block_getAlignment(entry), new_size);
+    if (!new_base) return NULL;
+
+    memcpy(new_base, entry->data, entry->size < new_size ? entry->size : new_size);
+    plat_aligned_free(entry->data);
+    return new_base;
 }
 
 SN_PUB_API_OPEN void* sn_realloc(void* ptr, size_t new_size)
@@ -115,7 +422,7 @@ SN_PUB_API_OPEN void* sn_realloc(void* ptr, size_t new_size)
         sn_error(SN_ERR_NULL_PTR, NULL);
     }
 
-    linked_list_entry_c entry = linked_list_getByPtr(mem_list, ptr);
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, ptr);
     if (!entry)
     {
         sn_error(SN_ERR_NO_ADDER_FOUND, NULL);
@@ -126,28 +433,106 @@ SN_PUB_API_OPEN void* sn_realloc(void* ptr, size_t new_size)
         sn_error(SN_ERR_BAD_SIZE, NULL);
     }
 
-    if (new_size > entry->size)
+    const size_t growth = new_size > entry->size ? new_size - entry->size : 0;
+    if (growth && !sn_pri_limit_reserve(growth, entry->tag))
     {
-        if (!memman_canAllocateBasedOnLimitAndSize(memory_manager, new_size - entry->size))
-        {
-            sn_error(SN_ERR_ALLOC_LIMIT_HIT, NULL);
-        }
+        sn_error(SN_ERR_ALLOC_LIMIT_HIT, NULL);
+    }
+
+    // Growing into slack the allocator already gave us, only the bookkeeping changes
+    // Shrinks still go to the allocator so it can take the tail back
+    if (new_size >= entry->size && new_size <= entry->usable)
+    {
+        sn_pri_registry_resize(entry, ptr, new_size);
+        return ptr;
+    }
+
+    const size_t header_size = (entry->flags & SN_BLOCK_FLAG_INLINE_HEADER) ? SN_BLOCK_HEADER_SIZE : 0;
+    if (new_size > SIZE_MAX - header_size - plat_getPageSize())
+    {
+        sn_pri_limit_release(growth, entry->tag);
+        sn_error(SN_ERR_BAD_SIZE, NULL);
     }
 
-    void* new_ptr = plat_realloc(ptr, new_size);
+    void* new_base;
+    if (entry->flags & SN_BLOCK_FLAG_MAPPED)
+        new_base = plat_remap(sn_block_getBase(entry), sn_block_getMappedLength(entry), sn_block_mappedLength(header_size, new_size));
+    else if (entry->flags & SN_BLOCK_FLAG_ALIGNED)
+        new_base = sn_pri_aligned_realloc(entry, new_size);
+    else
+        new_base = plat_backend_realloc(entry->backend, sn_block_getBase(entry), new_size + header_size);
 
-    if (!new_ptr)
+    if (!new_base)
     {
+        sn_pri_limit_release(growth, entry->tag);
         sn_error(SN_ERR_BAD_ALLOC, NULL);
     }
-    memory_manager->global_memory_usage -= entry->size;
-    memory_manager->global_memory_usage += new_size;
+    void* new_ptr = (uint8_t*)new_base + header_size;
 
-    linked_list_entry_setData(entry, new_ptr);
-    linked_list_entry_setSize(entry, new_size);
+
+    if (new_ptr != ptr)
+        memman_cacheInvalidate(memory_manager, ptr);
+
+    entry->flags &= ~SN_BLOCK_FLAG_SIZE_CLASS; // libc sized it to new_size, it no longer fits a bin
+    sn_pri_registry_resize(entry, new_ptr, new_size);
+
+    if (new_ptr != ptr && header_size)
+        sn_block_headerInstall(new_ptr, entry); // The magic is bound to the old address
+
+    entry->usable = sn_block_queryUsable(entry);
     return new_ptr;
 }
 
+SN_PUB_API_OPEN void* sn_aligned_alloc(size_t alignment, size_t size)
+{
+    if (size == 0)
+    {
+        sn_error(SN_ERR_BAD_SIZE, NULL);
+    }
+
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        sn_error(SN_ERR_BAD_ALIGNMENT, NULL);
+    }
+
+    if (!mem_registry && !sn_pri_lazy_init())
+        return plat_aligned_alloc(alignment, size);
+
+    if (!sn_pri_limit_reserve(size, sn_pri_current_tag()))
+    {
+        sn_error(SN_ERR_ALLOC_LIMIT_HIT, NULL);
+    }
+
+    // No inline header, it would have to be padded out to a whole alignment
+    void* base = plat_aligned_alloc(alignment, size);
+
+    if (!base)
+    {
+        sn_pri_limit_release(size, sn_pri_current_tag());
+        sn_error(SN_ERR_BAD_ALLOC, NULL);
+    }
+
+    if (memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_ALLOC, size))
+        sn_block_clear(base, size, SN_TRUE);
+    uint8_t align_log2 = 0;
+    while (((size_t)1 << align_log2) < alignment) align_log2++;
+
+    // Nobody has the pointer yet so setting the alignment after the insert is fine
+    linked_list_entry_c entry = sn_pri_track_new_block(base, 0, size, SN_BLOCK_FLAG_ALIGNED, PLAT_BACKEND_LIBC);
+    entry->align_log2 = align_log2;
+    return entry->data;
+}
+
+SN_PUB_API_OPEN void* sn_malloc_cacheline(size_t size)
+{
+    return sn_aligned_alloc(SN_CACHE_LINE_SIZE, size);
+}
+
+SN_PUB_API_OPEN void* sn_malloc_pages(size_t size)
+{
+    return sn_aligned_alloc(plat_getPageSize(), size);
+}
+
 SN_PUB_API_OPEN void* sn_malloc_pre_initialized(size_t size, uint8_t initial_byte_value)
 {
     void* ptr = sn_malloc(size);
@@ -163,3 +548,81 @@ SN_PUB_API_OPEN void sn_do_auto_free_at_exit(SN_FLAG val)
     doFree = val;
     plat_mutex_unlock(alloc_mutex);
 }
+
+SN_PUB_API_OPEN void sn_do_teardown_at_exit(SN_FLAG val)
+{
+    plat_atomic_store(&doTeardown, val);
+}
+
+SN_PUB_API_OPEN void sn_set_sanitize_policy(sn_sanitize_mode_e mode, size_t max_size)
+{
+    plat_mutex_lock(alloc_mutex);
+    memory_manager->sanitize_mode = (uint8_t)(mode & SN_SANITIZE_ALWAYS);
+    memory_manager->sanitize_max_size = max_size;
+    plat_mutex_unlock(alloc_mutex);
+}
+
+SN_PUB_API_OPEN void sn_set_mmap_threshold(size_t threshold)
+{
+    plat_mutex_lock(alloc_mutex);
+    memory_manager->mmap_threshold = threshold;
+    plat_mutex_unlock(alloc_mutex);
+}
+
+SN_PUB_API_OPEN void sn_do_huge_pages(SN_FLAG val)
+{
+    plat_mutex_lock(alloc_mutex);
+    memory_manager->use_huge_pages = val;
+    plat_mutex_unlock(alloc_mutex);
+}
+
+static SN_BOOL sn_pri_set_backend(plat_backend_use_e use, const sn_backend_ops_t* ops)
+{
+    if (ops && (!ops->malloc_fn || !ops->realloc_fn || !ops->free_fn))
+    {
+        sn_error(SN_ERR_NULL_PTR, SN_FALSE);
+    }
+
+    plat_mutex_lock(alloc_mutex);
+    const SN_BOOL installed = plat_backend_install(use, ops);
+    plat_mutex_unlock(alloc_mutex);
+
+    if (!installed)
+    {
+        sn_error(SN_ERR_BACKEND_LIMIT, SN_FALSE);
+    }
+    return SN_TRUE;
+}
+
+SN_PUB_API_OPEN SN_BOOL sn_set_backend_allocator(const sn_backend_ops_t* ops)
+{
+    return sn_pri_set_backend(PLAT_BACKEND_FOR_BLOCKS, ops);
+}
+
+SN_PUB_API_OPEN SN_BOOL sn_set_node_backend_allocator(const sn_backend_ops_t* ops)
+{
+    return sn_pri_set_backend(PLAT_BACKEND_FOR_NODES, ops);
+}
+
+SN_PUB_API_OPEN const sn_backend_ops_t* sn_get_libc_backend_allocator()
+{
+    return plat_backend_getLibc();
+}
+
+SN_PUB_API_OPEN void sn_do_thread_cache(SN_FLAG val)
+{
+#if defined(SN_CONFIG_ENABLE_THREAD_CACHE) && !defined(BUILDING_SAFETYNET_PRELOAD) // Stays off there, see memman_new
+    plat_mutex_lock(alloc_mutex);
+    memory_manager->use_thread_cache = val;
+    plat_mutex_unlock(alloc_mutex);
+#endif
+}
+
+SN_PUB_API_OPEN void sn_do_inline_headers(SN_FLAG val)
+{
+#ifdef SN_CONFIG_ENABLE_INLINE_HEADER
+    plat_mutex_lock(alloc_mutex);
+    memory_manager->use_inline_headers = val;
+    plat_mutex_unlock(alloc_mutex);
+#endif
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// An arena is a plain sn_malloc block with this header at the front,
+// sub allocations never touch the registry
+
+#include "libsafetynet.h"
+#include "_pri_api.h"
+#include "sn_block.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "platform_independent/plat_atomic.h"
+
+#define SN_ARENA_MAGIC ((uintptr_t)0xA7E4A5AFE7E7A000ULL)
+#define SN_ARENA_ALIGNMENT ((size_t)16)
+#define sn_arena_pri_alignUp(x) (((x) + SN_ARENA_ALIGNMENT - 1) & ~(SN_ARENA_ALIGNMENT - 1))
+
+struct sn_arena_s
+{
+    uintptr_t magic;  // SN_ARENA_MAGIC ^ arena, cleared on destroy
+    size_t capacity;  // Bytes available after the header
+    size_t used;      // Bump offset, only moves through plat_atomic_cas
+};
+
+#define SN_ARENA_HEADER_SIZE sn_arena_pri_alignUp(sizeof(sn_arena_t))
+
+static uint8_t* sn_arena_pri_base(sn_arena_t* arena)
+{
+    return (uint8_t*)arena + SN_ARENA_HEADER_SIZE;
+}
+
+static SN_BOOL sn_arena_pri_valid(const sn_arena_t* arena)
+{
+    return arena->magic == (SN_ARENA_MAGIC ^ (uintptr_t)arena);
+}
+
+SN_PUB_API_OPEN sn_arena_t* sn_arena_create(size_t capacity)
+{
+    if (!capacity || capacity > SIZE_MAX - SN_ARENA_HEADER_SIZE - (SN_ARENA_ALIGNMENT - 1))
+    {
+        sn_error(SN_ERR_BAD_SIZE, NULL);
+    }
+    capacity = sn_arena_pri_alignUp(capacity); // Allocations are padded, capacity has to be too or the last one never fits
+
+    sn_arena_t* arena = sn_malloc(SN_ARENA_HEADER_SIZE + capacity);
+    if (!arena) return NULL;
+
+    arena->magic = SN_ARENA_MAGIC ^ (uintptr_t)arena;
+    arena->capacity = capacity;
+    arena->used = 0;
+    return arena;
+}
+
+SN_PUB_API_OPEN void* sn_arena_alloc(sn_arena_t* arena, size_t size)
+{
+    if (!arena)
+    {
+        sn_error(SN_ERR_NULL_PTR, NULL);
+    }
+
+    if (!sn_arena_pri_valid(arena))
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND, NULL);
+    }
+
+    if (!size || size > arena->capacity)
+    {
+        sn_error(size ? SN_ERR_ARENA_FULL : SN_ERR_BAD_SIZE, NULL);
+    }
+
+    const size_t padded = sn_arena_pri_alignUp(size);
+    size_t used = plat_atomic_load_relaxed(&arena->used);
+    do
+    {
+        if (padded > arena->capacity - used)
+        {
+            sn_error(SN_ERR_ARENA_FULL, NULL);
+        }
+    } while (!plat_atomic_cas(&arena->used, &used, used + padded));
+
+    return sn_arena_pri_base(arena) + used;
+}
+
+SN_PUB_API_OPEN void sn_arena_reset(sn_arena_t* arena)
+{
+    if (!arena)
+    {
+        sn_error(SN_ERR_NULL_PTR);
+    }
+
+    if (!sn_arena_pri_valid(arena))
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND);
+    }
+
+    if (memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_FREE, arena->used))
+        sn_block_clear(sn_arena_pri_base(arena), arena->used, SN_FALSE);
+    plat_atomic_store(&arena->used, 0);
+}
+
+SN_PUB_API_OPEN void sn_arena_destroy(sn_arena_t* arena)
+{
+    if (!arena)
+    {
+        sn_error(SN_ERR_NULL_PTR);
+    }
+
+    if (!sn_arena_pri_valid(arena))
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND);
+    }
+
+    arena->magic = 0; // So a second destroy can't pass the check if the memory is reused
+    sn_free(arena);
+}
@@ -29,7 +29,7 @@ SN_PUB_API_OPEN SN_FLAG sn_request_to_fast_cache(const void* ptr)
         sn_error(SN_ERR_NULL_PTR, 0);
     }
 
-    linked_list_entry_c entry = linked_list_getByPtr(mem_list, (void*)ptr);
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, (void*)ptr);
     if (!entry)
     {
         sn_error(SN_ERR_NO_ADDER_FOUND, 0);
@@ -58,3 +58,13 @@ SN_PUB_API_OPEN void sn_fast_cache_clear()
     memman_cacheClear(memory_manager);
 }
 
+SN_PUB_API_OPEN size_t sn_set_fast_cache_size(size_t slots)
+{
+    size_t ret = memman_setCacheSize(memory_manager, slots);
+    if (!ret)
+    {
+        sn_error(SN_ERR_BAD_ALLOC, 0);
+    }
+    return ret;
+}
+
@@ -48,6 +48,10 @@ static const char* const human_readable_messages[191] = {
     [SN_ERR_FILE_IO] = "Libc Generic file IO error",
     [SN_ERR_FILE_NOT_EXIST] = "file Does not exist",
     [SN_ERR_ALLOC_LIMIT_HIT] = "User defined alloc limit has been hit",
+    [SN_ERR_ARENA_FULL] = "Arena has no room left for the allocation",
+    [SN_ERR_BAD_ALIGNMENT] = "Alignment is not a power of two",
+    [SN_ERR_BACKEND_LIMIT] = "No slot left to install another backend allocator",
+    [SN_ERR_TAG_DEPTH] = "Tag nested deeper than SN_TAG_MAX_DEPTH",
     [SN_WARN_DUB_FREE] = "Possible double free, but not found in registry",
     [SN_ERR_SYS_FAIL] = "generic system failure",
     [SN_ERR_CATASTROPHIC] = "Catastrophic system error",
@@ -68,6 +72,10 @@ static const char* const err_name_tap[191] = {
     [SN_ERR_FILE_IO] = "SN_ERR_FILE_IO",
     [SN_ERR_FILE_NOT_EXIST] = "SN_ERR_FILE_NOT_EXIST",
     [SN_ERR_ALLOC_LIMIT_HIT] = "SN_ERR_ALLOC_LIMIT_HIT",
+    [SN_ERR_ARENA_FULL] = "SN_ERR_ARENA_FULL",
+    [SN_ERR_BAD_ALIGNMENT] = "SN_ERR_BAD_ALIGNMENT",
+    [SN_ERR_BACKEND_LIMIT] = "SN_ERR_BACKEND_LIMIT",
+    [SN_ERR_TAG_DEPTH] = "SN_ERR_TAG_DEPTH",
     [SN_WARN_DUB_FREE] = "SN_WARN_DUB_FREE",
     [SN_ERR_SYS_FAIL] = "SN_ERR_SYS_FAIL",
     [SN_ERR_CATASTROPHIC] = "SN_ERR_CATASTROPHIC",
@@ -47,13 +47,10 @@ SN_PUB_API_OPEN SN_FLAG sn_dump_to_file(const char* file, void* block)
         sn_error(SN_ERR_FILE_PRE_EXIST, 0);
     }
 
-    linked_list_entry_c entry = memman_TryCacheHit(memory_manager, block);
-
-    if (entry == MEMMAN_CACHE_MISS)
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, block);
+    if (!entry)
     {
-        entry = linked_list_getByPtr(mem_list, block);
-        if (!entry)
-            sn_error(SN_ERR_NO_ADDER_FOUND, 0);
+        sn_error(SN_ERR_NO_ADDER_FOUND, 0);
     }
 
     FILE* f = fopen(file, "wb");
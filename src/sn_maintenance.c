@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Work that used to be stolen from every query call (a full registry walk to refill the fast cache)
+// now runs here, on a thread of its own every period or on the caller's thread through sn_maintenance_run_once
+
+#include "libsafetynet.h"
+#include "_pri_api.h"
+#include "platform_independent/plat_atomic.h"
+
+typedef struct sn_maintenance_s
+{
+    plat_mutex_c control;                 // Serializes start and stop, the worker never takes it
+    plat_event_c wake;                    // Cuts the worker's sleep short (stop or a new period)
+    plat_thread_c thread;                 // NULL while not running
+    uint32_t period_ms;
+    SN_FLAG stop;
+    SN_FLAG paused;
+
+    size_t passes;
+    size_t blocks_scanned;
+    size_t sampled_usage;
+    size_t peak_sampled_usage;
+} sn_maintenance_t;
+
+static sn_maintenance_t maintenance = {0};
+
+static void sn_maintenance_pri_pass()
+{
+    if (!mem_registry) return;
+
+    // Cache promotion
+    memman_work(memory_manager, mem_registry);
+
+    // Housekeeping, budget parked on threads that went quiet goes back to the shared pool
+    memman_reclaimBudgets(memory_manager, thread_usage);
+
+    // Stats sampling
+    const size_t usage = memman_getGlobalMemoryUsage(memory_manager);
+    const size_t blocks = registry_getSize(mem_registry);
+    stats_notePeak(usage, blocks);
+    plat_atomic_store_relaxed(&maintenance.blocks_scanned, blocks);
+    plat_atomic_store_relaxed(&maintenance.sampled_usage, usage);
+    size_t peak = plat_atomic_load_relaxed(&maintenance.peak_sampled_usage);
+    while (usage > peak && !plat_atomic_cas(&maintenance.peak_sampled_usage, &peak, usage))
+    {
+    }
+    plat_atomic_fetch_add(&maintenance.passes, 1);
+}
+
+static void sn_maintenance_pri_worker(void* arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        plat_event_wait(maintenance.wake, plat_atomic_load_relaxed(&maintenance.period_ms));
+        if (plat_atomic_load(&maintenance.stop)) return;
+        if (!plat_atomic_load_relaxed(&maintenance.paused))
+            sn_maintenance_pri_pass();
+    }
+}
+
+SN_BOOL sn_pri_maintenance_init()
+{
+    maintenance.control = plat_mutex_new();
+    maintenance.wake = plat_event_new();
+    return maintenance.control && maintenance.wake;
+}
+
+void sn_pri_maintenance_shutdown()
+{
+    sn_maintenance_stop();
+    plat_event_destroy(maintenance.wake);
+    plat_mutex_destroy(maintenance.control);
+    maintenance.wake = NULL;
+    maintenance.control = NULL;
+}
+
+SN_PUB_API_OPEN SN_BOOL sn_maintenance_start(uint32_t period_ms)
+{
+    if (!mem_registry && !sn_pri_lazy_init())
+    {
+        sn_error(SN_ERR_SYS_FAIL, SN_FALSE);
+    }
+    if (!period_ms) period_ms = SN_MAINTENANCE_DEFAULT_PERIOD_MS;
+
+    plat_mutex_lock(maintenance.control);
+    plat_atomic_store(&maintenance.period_ms, period_ms);
+    if (maintenance.thread)
+    {
+        // Wake it so the new period counts from now rather than after the old one runs out
+        plat_event_signal(maintenance.wake);
+        plat_mutex_unlock(maintenance.control);
+        return SN_TRUE;
+    }
+
+    plat_atomic_store(&maintenance.stop, SN_FLAG_UNSET);
+    maintenance.thread = plat_thread_new(&sn_maintenance_pri_worker, NULL);
+    const SN_BOOL started = maintenance.thread != NULL;
+    plat_mutex_unlock(maintenance.control);
+
+    if (!started)
+    {
+        sn_error(SN_ERR_SYS_FAIL, SN_FALSE);
+    }
+    return SN_TRUE;
+}
+
+SN_PUB_API_OPEN void sn_maintenance_stop()
+{
+    plat_mutex_lock(maintenance.control);
+    if (maintenance.thread)
+    {
+        plat_atomic_store(&maintenance.stop, SN_FLAG_SET);
+        plat_event_signal(maintenance.wake);
+        plat_thread_join(maintenance.thread);
+        maintenance.thread = NULL;
+    }
+    plat_mutex_unlock(maintenance.control);
+}
+
+SN_PUB_API_OPEN void sn_maintenance_pause()
+{
+    plat_atomic_store(&maintenance.paused, SN_FLAG_SET);
+}
+
+SN_PUB_API_OPEN void sn_maintenance_resume()
+{
+    plat_atomic_store(&maintenance.paused, SN_FLAG_UNSET);
+}
+
+SN_PUB_API_OPEN void sn_maintenance_run_once()
+{
+    sn_maintenance_pri_pass();
+}
+
+SN_PUB_API_OPEN SN_BOOL sn_query_maintenance_stats(sn_maintenance_stats_t* out)
+{
+    if (!out)
+    {
+        sn_error(SN_ERR_NULL_PTR, SN_FALSE);
+    }
+
+    plat_mutex_lock(maintenance.control);
+    out->running = maintenance.thread != NULL;
+    plat_mutex_unlock(maintenance.control);
+
+    out->passes = plat_atomic_load_relaxed(&maintenance.passes);
+    out->blocks_scanned = plat_atomic_load_relaxed(&maintenance.blocks_scanned);
+    out->sampled_usage = plat_atomic_load_relaxed(&maintenance.sampled_usage);
+    out->peak_sampled_usage = plat_atomic_load_relaxed(&maintenance.peak_sampled_usage);
+    out->paused = plat_atomic_load_relaxed(&maintenance.paused) ? SN_TRUE : SN_FALSE;
+    return SN_TRUE;
+}
@@ -22,22 +22,58 @@
 #include "_pri_api.h"
 #include <string.h>
 
+#include "platform_independent/plat_allocators.h"
+#include "platform_independent/plat_atomic.h"
+
+typedef struct
+{
+    uint16_t id;
+    linked_list_entry_c exclude;
+} _pri_id_search_t; // NOLINT(*-reserved-identifier)
+
+static linked_list_entry_c search_for_other_id(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
+{
+    const _pri_id_search_t* search = generic_arg;
+    stats_inc(STATS_SCAN_STEP);
+    if (ctx != search->exclude && ctx->block_id == search->id)
+    {
+        return ctx;
+    }
+    return NULL;
+}
+
+void sn_pri_release_block_id(linked_list_entry_c entry)
+{
+    const uint16_t id = linked_list_entry_getBlockId(entry);
+    if (!id) return;
+    const uint32_t others = id_table_release(block_id_table, id);
+    if (!id_table_clearIfOwner(block_id_table, id, entry)) return;
+    if (!others) return; // Nobody left to hand the id to, the usual case
+
+    // Only paid when the owner of a shared id goes away, lookups never scan
+    stats_inc(STATS_LOOKUP_SCAN);
+    linked_list_entry_c other = registry_forEach(mem_registry, &search_for_other_id, &(_pri_id_search_t){
+        id,
+        entry
+    });
+    if (other)
+        id_table_claim(block_id_table, id, other);
+}
+
 SN_PUB_API_OPEN SN_MSG_DEPRECATED("unsafe due to lack of The definition of size") void* sn_register(void* const ptr)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
-    linked_list_push(mem_list, ptr, 0, plat_getTid());
+    sn_pri_registry_insert(ptr, 0);
     return ptr;
 }
 
 SN_PUB_API_OPEN size_t sn_query_size(void* const ptr)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     if (!ptr)
     {
         sn_error(SN_ERR_NULL_PTR, 0);
     }
 
-    linked_list_entry_c entry = linked_list_getByPtr(mem_list, ptr);
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, ptr);
     if (!entry)
     {
         sn_error(SN_ERR_NO_ADDER_FOUND, 0);
@@ -46,21 +82,33 @@ SN_PUB_API_OPEN size_t sn_query_size(void* const ptr)
     return linked_list_entry_getSize(entry);
 }
 
-SN_PUB_API_OPEN sn_tid_t sn_query_tid(void* const ptr)
+SN_PUB_API_OPEN size_t sn_query_usable_size(void* const ptr)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     if (!ptr)
     {
         sn_error(SN_ERR_NULL_PTR, 0);
     }
 
-    linked_list_entry_c entry = memman_TryCacheHit(memory_manager, ptr);
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, ptr);
+    if (!entry)
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND, 0);
+    }
 
-    if (entry == MEMMAN_CACHE_MISS)
+    return entry->usable > entry->size ? entry->usable : entry->size;
+}
+
+SN_PUB_API_OPEN sn_tid_t sn_query_tid(void* const ptr)
+{
+    if (!ptr)
+    {
+        sn_error(SN_ERR_NULL_PTR, 0);
+    }
+
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, ptr);
+    if (!entry)
     {
-        entry = linked_list_getByPtr(mem_list, ptr);
-        if (!entry)
-            sn_error(SN_ERR_NO_ADDER_FOUND, 0);
+        sn_error(SN_ERR_NO_ADDER_FOUND, 0);
     }
 
     return linked_list_entry_getTid(entry);
@@ -68,7 +116,6 @@ SN_PUB_API_OPEN sn_tid_t sn_query_tid(void* const ptr)
 
 SN_PUB_API_OPEN void* sn_register_size(void* ptr, size_t size)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     if (!ptr)
     {
         sn_error(SN_ERR_NULL_PTR, NULL);
@@ -79,32 +126,44 @@ SN_PUB_API_OPEN void* sn_register_size(void* ptr, size_t size)
         sn_error(SN_ERR_BAD_SIZE, NULL);
     }
 
-    if (linked_list_hasPtr(mem_list, ptr)) return ptr;
+    if (registry_hasPtr(mem_registry, ptr)) return ptr;
 
-    linked_list_push(mem_list, ptr, size, plat_getTid());
+    sn_pri_limit_charge(size, sn_pri_current_tag());
+    sn_pri_registry_insert(ptr, size);
     return ptr;
 }
 
 SN_PUB_API_OPEN SN_FLAG sn_is_tracked_block(const void* const ptr)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     if (!ptr)
     {
         sn_error(SN_ERR_NULL_PTR, 0);
     }
 
-    SN_BOOL not_has_entry = (memman_TryCacheHit(memory_manager, (void*)ptr) == MEMMAN_CACHE_MISS);
-    if (not_has_entry)
+    return memman_findEntry(memory_manager, mem_registry, (void*)ptr) != NULL;
+}
+
+SN_PUB_API_OPEN void* sn_find_containing_block(const void* addr, size_t* out_offset)
+{
+    if (!addr)
     {
-        return not_has_entry;
+        sn_error(SN_ERR_NULL_PTR, NULL);
     }
 
-    return linked_list_hasPtr(mem_list, (void*)ptr);
+    linked_list_entry_c entry = registry_getContaining(mem_registry, addr);
+    if (!entry)
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND, NULL);
+    }
+
+    if (out_offset)
+        *out_offset = (size_t)((uintptr_t)addr - (uintptr_t)entry->data);
+
+    return entry->data;
 }
 
 SN_PUB_API_OPEN void sn_set_block_id(void* block, uint16_t id)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     if (!block)
     {
         sn_error(SN_ERR_NULL_PTR);
@@ -115,33 +174,40 @@ SN_PUB_API_OPEN void sn_set_block_id(void* block, uint16_t id)
         sn_error(SN_ERR_BAD_BLOCK_ID);
     }
 
-    linked_list_entry_c entry = memman_TryCacheHit(memory_manager, block);
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, block);
+    if (!entry)
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND);
+    }
 
-    if (entry == MEMMAN_CACHE_MISS)
+    if (linked_list_entry_getBlockId(entry) != id)
     {
-        entry = linked_list_getByPtr(mem_list, block);
-        if (!entry)
-            sn_error(SN_ERR_NO_ADDER_FOUND);
+        sn_pri_release_block_id(entry);
+        if (!id_table_retain(block_id_table, id))
+        {
+            linked_list_entry_setBlockId(entry, 0);
+            sn_error(SN_ERR_BAD_ALLOC);
+        }
+        linked_list_entry_setBlockId(entry, id);
     }
 
-    linked_list_entry_setBlockId(entry, id);
+    if (!id_table_claim(block_id_table, id, entry))
+    {
+        sn_error(SN_ERR_BAD_ALLOC);
+    }
 }
 
 SN_PUB_API_OPEN uint16_t sn_get_block_id(void* block)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     if (!block)
     {
         sn_error(SN_ERR_NULL_PTR, 0);
     }
 
-    linked_list_entry_c entry = memman_TryCacheHit(memory_manager, block);
-
-    if (entry == MEMMAN_CACHE_MISS)
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, block);
+    if (!entry)
     {
-        entry = linked_list_getByPtr(mem_list, block);
-        if (!entry)
-            sn_error(SN_ERR_NO_ADDER_FOUND, 0);
+        sn_error(SN_ERR_NO_ADDER_FOUND, 0);
     }
 
     return linked_list_entry_getBlockId(entry);
@@ -149,19 +215,15 @@ SN_PUB_API_OPEN uint16_t sn_get_block_id(void* block)
 
 SN_PUB_API_OPEN void* sn_query_block_id(uint16_t id)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     if (!id)
     {
         sn_error(SN_ERR_BAD_BLOCK_ID, NULL);
     }
 
-    linked_list_entry_c entry = memman_TryCacheHitById(memory_manager, id);
-
-    if (entry == MEMMAN_CACHE_MISS)
+    linked_list_entry_c entry = id_table_get(block_id_table, id);
+    if (!entry)
     {
-        entry = linked_list_getById(mem_list, id);
-        if (!entry)
-            sn_error(SN_ERR_NO_ADDER_FOUND, NULL);
+        sn_error(SN_ERR_NO_ADDER_FOUND, NULL);
     }
 
     return linked_list_entry_getData(entry);
@@ -169,19 +231,15 @@ SN_PUB_API_OPEN void* sn_query_block_id(uint16_t id)
 
 SN_PUB_API_OPEN const sn_mem_metadata_t* sn_query_metadata(void* ptr)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     if (!ptr)
     {
         sn_error(SN_ERR_NULL_PTR, NULL);
     }
 
-    linked_list_entry_c entry = memman_TryCacheHit(memory_manager, ptr);
-
-    if (entry == MEMMAN_CACHE_MISS)
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, ptr);
+    if (!entry)
     {
-        entry = linked_list_getByPtr(mem_list, ptr);
-        if (!entry)
-            sn_error(SN_ERR_NO_ADDER_FOUND, NULL);
+        sn_error(SN_ERR_NO_ADDER_FOUND, NULL);
     }
 
     //Yes very spooky, but it's a known good view into memory
@@ -190,7 +248,6 @@ SN_PUB_API_OPEN const sn_mem_metadata_t* sn_query_metadata(void* ptr)
 
 SN_PUB_API_OPEN const sn_mem_metadata_t* sn_query_static_metadata(void* ptr)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     const sn_mem_metadata_t* mem_metadata = sn_query_metadata(ptr);
     if (!mem_metadata) return NULL;
 
@@ -205,57 +262,42 @@ SN_PUB_API_OPEN const sn_mem_metadata_t* sn_query_static_metadata(void* ptr)
 
 void sn_set_alloc_limit(size_t limit)
 {
-    memory_manager->alloc_limit = limit;
+    plat_mutex_lock(alloc_mutex);
+    memman_setAllocLimit(memory_manager, thread_usage, limit);
+    plat_mutex_unlock(alloc_mutex);
 }
 
-typedef struct
+SN_PUB_API_OPEN
+size_t sn_query_thread_memory_usage(sn_tid_t tid)
 {
-    sn_tid_t tid;
-    size_t* out_size;
-} _pri_tid_size_t; // NOLINT(*-reserved-identifier)
+    const thread_usage_record_t* record = thread_usage_findRecord(thread_usage, tid);
+    if (!record) return 0;
 
-static linked_list_entry_c search_for_tid(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
-{
-    if (ctx->tid == ((_pri_tid_size_t*)generic_arg)->tid)
-    {
-        (*((_pri_tid_size_t*)generic_arg)->out_size) += ctx->size;
-    }
-    return NULL;
+    return plat_atomic_load_relaxed(&record->bytes);
 }
 
 SN_PUB_API_OPEN
-size_t sn_query_thread_memory_usage(sn_tid_t tid)
+size_t sn_query_all_thread_memory_usage(sn_thread_memory_usage_t* out, size_t max_count)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
-    size_t siz = 0;
-    linked_list_forEach(mem_list, &search_for_tid, &(_pri_tid_size_t){
-        tid,
-        &siz
-    });
-
-    return siz;
+    return thread_usage_snapshot(thread_usage, out, max_count);
 }
 
 SN_PUB_API_OPEN size_t sn_query_total_memory_usage()
 {
-    return memory_manager->global_memory_usage;
+    return memman_getGlobalMemoryUsage(memory_manager);
 }
 
 SN_PUB_API_OPEN uint64_t sn_calculate_checksum(void* block)
 {
-    memman_work(memory_manager, mem_list); // Let's Steal some CPU time
     if (!block)
     {
         sn_error(SN_ERR_NULL_PTR, 0);
     }
 
-    linked_list_entry_c entry = memman_TryCacheHit(memory_manager, block);
-
-    if (entry == MEMMAN_CACHE_MISS)
+    linked_list_entry_c entry = memman_findEntry(memory_manager, mem_registry, block);
+    if (!entry)
     {
-        entry = linked_list_getByPtr(mem_list, block);
-        if (!entry)
-            sn_error(SN_ERR_NO_ADDER_FOUND, 0);
+        sn_error(SN_ERR_NO_ADDER_FOUND, 0);
     }
 
     const size_t size = linked_list_entry_getSize(entry);
@@ -286,38 +328,83 @@ SN_PUB_API_OPEN uint64_t sn_calculate_checksum(void* block)
 
 typedef struct
 {
-    void* real_generic_arg;
-    sn_metadata_for_each_worker_f worker;
-    sn_mem_metadata_t** out;
-} __sn_mem_metadata_for_each_data_t; // NOLINT(*-reserved-identifier)
+    linked_list_entry_c entry;
+    uint64_t generation; // entry's stamp when it was pinned
+    sn_mem_metadata_t metadata; // Copied while the shard lock kept it from being freed or reused
+} _pri_metadata_pin_t; // NOLINT(*-reserved-identifier)
 
-static linked_list_entry_c mem_metadata_for_each(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
+typedef struct
+{
+    _pri_metadata_pin_t* pins;
+    size_t count;
+    size_t capacity;
+    SN_BOOL failed;
+} _pri_metadata_pins_t; // NOLINT(*-reserved-identifier)
+
+// Runs under a shard read lock, so it only notes the entry down along with a copy of its metadata
+static linked_list_entry_c mem_metadata_pin(linked_list_c self, linked_list_entry_c ctx, size_t index, void* generic_arg)
 {
-    __sn_mem_metadata_for_each_data_t* real_arg = (__sn_mem_metadata_for_each_data_t*)generic_arg;
-    sn_mem_metadata_t* rt = real_arg->worker((sn_mem_metadata_t*)&ctx->data, index, generic_arg);
-    if (rt != NULL)
+    _pri_metadata_pins_t* pins = generic_arg;
+    if (pins->count == pins->capacity)
     {
-        *real_arg->out = rt;
-        return LIST_FOR_EACH_LOOP_BRAKE;
+        const size_t capacity = pins->capacity * 2;
+        _pri_metadata_pin_t* grown = plat_realloc(pins->pins, capacity * sizeof(_pri_metadata_pin_t));
+        if (!grown)
+        {
+            pins->failed = SN_TRUE;
+            return LIST_FOR_EACH_LOOP_BRAKE;
+        }
+        pins->pins = grown;
+        pins->capacity = capacity;
     }
+    _pri_metadata_pin_t* pin = &pins->pins[pins->count++];
+    pin->entry = ctx;
+    pin->generation = plat_atomic_load(&ctx->generation);
+    memcpy(&pin->metadata, &ctx->data, sizeof(sn_mem_metadata_t));
     return NULL;
 }
 
 sn_mem_metadata_t* sn_mem_metadata_for_each(sn_metadata_for_each_worker_f worker, void* generic_arg)
 {
-    sn_mem_metadata_t* out = NULL;
-    __sn_mem_metadata_for_each_data_t data = {
-        generic_arg,
-        worker,
-        &out
+    if (!worker)
+    {
+        sn_error(SN_ERR_NULL_PTR, NULL);
+    }
+
+    // The worker is outside code that may call back in, so it runs on pinned entries with no lock held
+    _pri_metadata_pins_t pins = {
+        NULL,
+        0,
+        registry_getSize(mem_registry) + 64, // Room for what gets allocated while we walk
+        SN_FALSE
     };
+    pins.pins = plat_malloc(pins.capacity * sizeof(_pri_metadata_pin_t));
+    if (!pins.pins)
+    {
+        sn_error(SN_ERR_BAD_ALLOC, NULL);
+    }
 
-    void* temp = linked_list_forEach(mem_list, &mem_metadata_for_each, &data);
+    registry_forEach(mem_registry, &mem_metadata_pin, &pins);
+    if (pins.failed)
+    {
+        plat_free(pins.pins);
+        sn_error(SN_ERR_BAD_ALLOC, NULL);
+    }
 
-    if (temp == LIST_FOR_EACH_LOOP_BRAKE)
+    sn_mem_metadata_t* out = NULL;
+    size_t index = 0;
+    for (size_t i = 0; i < pins.count && !out; i++)
     {
-        return out;
+        // Freed or moved since it was pinned (maybe by the worker itself), its node may be another block's by now
+        _pri_metadata_pin_t* pin = &pins.pins[i];
+        if (!pin->generation || plat_atomic_load(&pin->entry->generation) != pin->generation) continue;
+        // The worker gets the copy, the block can still be freed while it runs
+        out = worker(&pin->metadata, index++, generic_arg);
+        if (out == &pin->metadata)
+            out = (sn_mem_metadata_t*)&pin->entry->data; // The copy goes away with pins
     }
-    return NULL;
+
+    plat_free(pins.pins);
+    return out;
 }
 
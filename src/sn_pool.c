@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// A pool hands out fixed size objects from tracked chunks, the registry only sees the chunks
+// Free objects form an intrusive list through their first word, a chunk is bump allocated before anything
+// is freed into it so creating one never walks it
+
+#include "libsafetynet.h"
+#include "_pri_api.h"
+#include "sn_block.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#define SN_POOL_MAGIC ((uintptr_t)0x9001C0FFEE5AFE00ULL)
+#define SN_POOL_ALIGNMENT ((size_t)16)
+#define sn_pool_pri_alignUp(x) (((x) + SN_POOL_ALIGNMENT - 1) & ~(SN_POOL_ALIGNMENT - 1))
+
+typedef struct sn_pool_slot_s
+{
+    struct sn_pool_slot_s* next;
+} sn_pool_slot_t;
+
+typedef struct sn_pool_chunk_s
+{
+    struct sn_pool_chunk_s* next;
+} sn_pool_chunk_t;
+
+#define SN_POOL_CHUNK_HEADER_SIZE sn_pool_pri_alignUp(sizeof(sn_pool_chunk_t))
+
+struct sn_pool_s
+{
+    uintptr_t magic;             // SN_POOL_MAGIC ^ pool, cleared on destroy
+    plat_mutex_c mutex;
+    size_t object_size;
+    size_t objects_per_chunk;
+    size_t chunk_size;           // Bytes per chunk including its header
+    sn_pool_slot_t* free_list;
+    uint8_t* bump;               // Next never used object in the newest chunk
+    uint8_t* bump_end;
+    sn_pool_chunk_t* chunks;     // Newest first
+    size_t chunk_count;
+    size_t live;
+};
+
+static SN_BOOL sn_pool_pri_valid(const sn_pool_t* pool)
+{
+    return pool->magic == (SN_POOL_MAGIC ^ (uintptr_t)pool);
+}
+
+SN_PUB_API_OPEN sn_pool_t* sn_pool_create(size_t object_size, size_t objects_per_chunk)
+{
+    if (!object_size || !objects_per_chunk || object_size > SIZE_MAX - SN_POOL_ALIGNMENT)
+    {
+        sn_error(SN_ERR_BAD_SIZE, NULL);
+    }
+
+    const size_t slot_size = sn_pool_pri_alignUp(object_size);
+    if (objects_per_chunk > (SIZE_MAX - SN_POOL_CHUNK_HEADER_SIZE) / slot_size)
+    {
+        sn_error(SN_ERR_BAD_SIZE, NULL);
+    }
+
+    sn_pool_t* pool = sn_malloc(sizeof(sn_pool_t));
+    if (!pool) return NULL;
+
+    memset(pool, 0, sizeof(sn_pool_t));
+    pool->mutex = plat_mutex_new();
+    if (!pool->mutex)
+    {
+        sn_free(pool);
+        sn_error(SN_ERR_BAD_ALLOC, NULL);
+    }
+
+    pool->object_size = slot_size;
+    pool->objects_per_chunk = objects_per_chunk;
+    pool->chunk_size = SN_POOL_CHUNK_HEADER_SIZE + slot_size * objects_per_chunk;
+    pool->magic = SN_POOL_MAGIC ^ (uintptr_t)pool;
+    return pool;
+}
+
+// Called with pool->mutex held once both the free list and the bump range are empty
+static SN_BOOL sn_pool_pri_grow(sn_pool_t* pool)
+{
+    sn_pool_chunk_t* chunk = sn_malloc(pool->chunk_size);
+    if (!chunk) return SN_FALSE;
+
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    pool->chunk_count++;
+    pool->bump = (uint8_t*)chunk + SN_POOL_CHUNK_HEADER_SIZE;
+    pool->bump_end = (uint8_t*)chunk + pool->chunk_size;
+    return SN_TRUE;
+}
+
+SN_PUB_API_OPEN void* sn_pool_alloc(sn_pool_t* pool)
+{
+    if (!pool)
+    {
+        sn_error(SN_ERR_NULL_PTR, NULL);
+    }
+
+    if (!sn_pool_pri_valid(pool))
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND, NULL);
+    }
+
+    void* object;
+    plat_mutex_lock(pool->mutex);
+    if (pool->free_list)
+    {
+        object = pool->free_list;
+        pool->free_list = pool->free_list->next;
+    }
+    else
+    {
+        if (pool->bump == pool->bump_end && !sn_pool_pri_grow(pool))
+        {
+            plat_mutex_unlock(pool->mutex);
+            return NULL; // sn_malloc set the error
+        }
+        object = pool->bump;
+        pool->bump += pool->object_size;
+    }
+    pool->live++;
+    plat_mutex_unlock(pool->mutex);
+
+    if (memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_ALLOC, pool->object_size))
+        sn_block_clear(object, pool->object_size, SN_FALSE);
+    return object;
+}
+
+SN_PUB_API_OPEN void sn_pool_free(sn_pool_t* pool, void* ptr)
+{
+    if (!pool || !ptr)
+    {
+        sn_error(SN_ERR_NULL_PTR);
+    }
+
+    if (!sn_pool_pri_valid(pool))
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND);
+    }
+
+    if (memman_shouldSanitize(memory_manager, SN_SANITIZE_ON_FREE, pool->object_size))
+        sn_block_clear(ptr, pool->object_size, SN_FALSE);
+
+    sn_pool_slot_t* slot = ptr;
+    plat_mutex_lock(pool->mutex);
+    slot->next = pool->free_list;
+    pool->free_list = slot;
+    pool->live--;
+    plat_mutex_unlock(pool->mutex);
+}
+
+SN_PUB_API_OPEN void sn_pool_destroy(sn_pool_t* pool)
+{
+    if (!pool)
+    {
+        sn_error(SN_ERR_NULL_PTR);
+    }
+
+    if (!sn_pool_pri_valid(pool))
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND);
+    }
+
+    pool->magic = 0; // So a second destroy can't pass the check if the memory is reused
+
+    sn_pool_chunk_t* chunk = pool->chunks;
+    while (chunk)
+    {
+        sn_pool_chunk_t* next = chunk->next;
+        sn_free(chunk);
+        chunk = next;
+    }
+
+    plat_mutex_destroy(pool->mutex);
+    sn_free(pool);
+}
+
+SN_PUB_API_OPEN SN_BOOL sn_query_pool_usage(sn_pool_t* pool, sn_pool_usage_t* out)
+{
+    if (!pool || !out)
+    {
+        sn_error(SN_ERR_NULL_PTR, SN_FALSE);
+    }
+
+    if (!sn_pool_pri_valid(pool))
+    {
+        sn_error(SN_ERR_NO_ADDER_FOUND, SN_FALSE);
+    }
+
+    plat_mutex_lock(pool->mutex);
+    out->object_size = pool->object_size;
+    out->chunks = pool->chunk_count;
+    out->capacity = pool->chunk_count * pool->objects_per_chunk;
+    out->live = pool->live;
+    out->bytes = pool->chunk_count * pool->chunk_size;
+    plat_mutex_unlock(pool->mutex);
+    return SN_TRUE;
+}
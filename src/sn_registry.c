@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Every block enters, leaves and changes size in the registry through here
+// so anything that keeps running totals only has to hook in one place
+
+#include "_pri_api.h"
+#include "sn_crash.h"
+
+static plat_thread_local thread_usage_record_t* current_thread_usage = NULL;
+
+static thread_usage_record_t* sn_pri_current_thread_usage()
+{
+    thread_usage_record_t* usage = current_thread_usage;
+    if (!usage)
+    {
+        usage = thread_usage_getRecord(thread_usage, plat_getTid());
+        current_thread_usage = usage;
+    }
+    return usage;
+}
+
+SN_BOOL sn_pri_limit_reserve(size_t size, tag_usage_node_t* tag)
+{
+    if (!tag_usage_tryCharge(tag, size)) return SN_FALSE;
+    if (!memman_reserve(memory_manager, thread_usage, sn_pri_current_thread_usage(), size))
+    {
+        tag_usage_uncharge(tag, size, 0);
+        return SN_FALSE;
+    }
+    return SN_TRUE;
+}
+
+void sn_pri_limit_release(size_t size, tag_usage_node_t* tag)
+{
+    tag_usage_uncharge(tag, size, 0);
+    memman_release(memory_manager, sn_pri_current_thread_usage(), size);
+}
+
+void sn_pri_limit_charge(size_t size, tag_usage_node_t* tag)
+{
+    tag_usage_charge(tag, size, 0);
+    memman_charge(memory_manager, size);
+}
+
+linked_list_entry_c sn_pri_registry_insert(void* data, size_t size)
+{
+    const sn_tid_t tid = plat_getTid();
+    linked_list_entry_c entry = registry_push(mem_registry, data, size, tid);
+    memman_stampEntry(entry);
+
+    entry->owner_usage = sn_pri_current_thread_usage();
+    thread_usage_recordCharge(entry->owner_usage, size, 1);
+    // The bytes were charged to the tag when they were reserved
+    entry->tag = sn_pri_current_tag();
+    tag_usage_charge(entry->tag, 0, 1);
+
+    return entry;
+}
+
+void sn_pri_registry_remove(linked_list_entry_c entry)
+{
+    memman_unstampEntry(entry);
+    // Always uncharge the allocating thread, whichever thread is freeing
+    thread_usage_recordUncharge(entry->owner_usage, entry->size, 1);
+    tag_usage_uncharge(entry->tag, 0, 1);
+    sn_pri_limit_release(entry->size, entry->tag);
+    registry_removeEntry(mem_registry, entry);
+}
+
+void sn_pri_registry_insertBatch(void* const* data, const size_t* sizes, size_t count, linked_list_entry_c* out)
+{
+    const sn_tid_t tid = plat_getTid();
+    registry_pushBatch(mem_registry, data, sizes, count, tid, out);
+
+    thread_usage_record_t* usage = sn_pri_current_thread_usage();
+    tag_usage_node_t* tag = sn_pri_current_tag();
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        memman_stampEntry(out[i]);
+        out[i]->owner_usage = usage;
+        out[i]->tag = tag;
+        bytes += sizes[i];
+    }
+    thread_usage_recordCharge(usage, bytes, count);
+    tag_usage_charge(tag, 0, count);
+}
+
+void sn_pri_registry_removeBatch(linked_list_entry_c* entries, size_t count)
+{
+    // Batches are nearly always freed by the thread that made them under one tag, so uncharge runs of the same owner in one go
+    thread_usage_record_t* owner = NULL;
+    size_t bytes = 0;
+    size_t blocks = 0;
+    tag_usage_node_t* tag = NULL;
+    size_t tag_bytes = 0;
+    size_t tag_blocks = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        memman_unstampEntry(entries[i]);
+        total += entries[i]->size;
+        if (entries[i]->owner_usage != owner)
+        {
+            thread_usage_recordUncharge(owner, bytes, blocks);
+            owner = entries[i]->owner_usage;
+            bytes = 0;
+            blocks = 0;
+        }
+        if (entries[i]->tag != tag)
+        {
+            tag_usage_uncharge(tag, tag_bytes, tag_blocks);
+            tag = entries[i]->tag;
+            tag_bytes = 0;
+            tag_blocks = 0;
+        }
+        bytes += entries[i]->size;
+        blocks++;
+        tag_bytes += entries[i]->size;
+        tag_blocks++;
+    }
+    thread_usage_recordUncharge(owner, bytes, blocks);
+    tag_usage_uncharge(tag, tag_bytes, tag_blocks);
+    sn_pri_limit_release(total, NULL);
+
+    registry_removeBatch(mem_registry, entries, count);
+}
+
+void sn_pri_registry_resize(linked_list_entry_c entry, void* new_data, size_t new_size)
+{
+    if (new_data != entry->data)
+    {
+        // A fresh stamp before the entry shows up under its new key, every lookup cache slot still naming it goes stale
+        memman_stampEntry(entry);
+        registry_rekeyEntry(mem_registry, entry, new_data);
+    }
+
+    // Growth was reserved against the limit by the caller
+    const size_t old_size = entry->size;
+    if (new_size > old_size)
+    {
+        thread_usage_recordCharge(entry->owner_usage, new_size - old_size, 0);
+    }
+    else
+    {
+        thread_usage_recordUncharge(entry->owner_usage, old_size - new_size, 0);
+        sn_pri_limit_release(old_size - new_size, entry->tag);
+    }
+
+    registry_resizeEntry(mem_registry, entry, new_size);
+}
+
+SN_BOOL sn_pri_registry_park(linked_list_entry_c entry)
+{
+    thread_cache_record_t* record = thread_cache_getRecord(thread_cache);
+    if (!thread_cache_recordHasRoom(record, entry->size)) return SN_FALSE;
+
+    thread_usage_recordUncharge(entry->owner_usage, entry->size, 1);
+    tag_usage_uncharge(entry->tag, 0, 1);
+    sn_pri_limit_release(entry->size, entry->tag);
+    memman_unstampEntry(entry);
+    registry_detachEntry(mem_registry, entry);
+    thread_cache_recordPut(record, entry);
+    return SN_TRUE;
+}
+
+linked_list_entry_c sn_pri_registry_unpark(size_t size)
+{
+    linked_list_entry_c entry = thread_cache_recordTake(thread_cache_getRecord(thread_cache), size);
+    if (!entry) return NULL;
+
+    // Everything but how the memory was obtained starts over
+    const sn_tid_t tid = plat_getTid();
+    entry->size = size;
+    entry->tid = tid;
+    entry->block_id = 0;
+    entry->cached = 0;
+    entry->_weight = 0;
+    entry->owner_usage = sn_pri_current_thread_usage();
+    thread_usage_recordCharge(entry->owner_usage, size, 1);
+    entry->tag = sn_pri_current_tag();
+    tag_usage_charge(entry->tag, 0, 1);
+    registry_attachEntry(mem_registry, entry);
+    memman_stampEntry(entry);
+
+    return entry;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+#include "libsafetynet.h"
+#include "_pri_api.h"
+
+SN_PUB_API_OPEN SN_BOOL sn_get_stats(sn_stats_t* out)
+{
+    if (!out)
+    {
+        sn_error(SN_ERR_NULL_PTR, SN_FALSE);
+    }
+
+    uint64_t counters[STATS_COUNTER_COUNT];
+    stats_sum(counters);
+
+    out->cache_hits = (size_t)counters[STATS_CACHE_HIT];
+    out->cache_misses = (size_t)counters[STATS_CACHE_MISS];
+    out->cache_evictions = (size_t)counters[STATS_CACHE_EVICTION];
+    out->cache_pins = (size_t)counters[STATS_CACHE_PIN];
+    out->cache_slots = memman_getCacheSize(memory_manager);
+
+    out->registry_blocks = registry_getSize(mem_registry);
+    out->registry_bytes = memman_getGlobalMemoryUsage(memory_manager);
+    stats_notePeak(out->registry_bytes, out->registry_blocks);
+
+    out->lookups_header = (size_t)counters[STATS_LOOKUP_HEADER];
+    out->lookups_thread_cache = (size_t)counters[STATS_LOOKUP_THREAD_CACHE];
+    out->lookups_cache = (size_t)counters[STATS_LOOKUP_CACHE];
+    out->lookups_index = (size_t)counters[STATS_LOOKUP_INDEX];
+    out->lookups_scan = (size_t)counters[STATS_LOOKUP_SCAN];
+    out->avg_scan_length = counters[STATS_LOOKUP_SCAN]
+        ? (double)counters[STATS_SCAN_STEP] / (double)counters[STATS_LOOKUP_SCAN]
+        : 0.0;
+
+    out->lock_acquisitions = (size_t)counters[STATS_LOCK_ACQUIRE];
+    out->lock_contended = (size_t)counters[STATS_LOCK_CONTENDED];
+
+    stats_getPeak(&out->peak_bytes, &out->peak_blocks);
+    return SN_TRUE;
+}
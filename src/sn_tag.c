@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026  Tetex7
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//
+// Created by tete on 10/17/2026.
+//
+
+// Allocation tags, a per thread stack of where allocations should be charged
+
+#include "libsafetynet.h"
+#include "_pri_api.h"
+
+#include "platform_independent/plat_atomic.h"
+
+static plat_thread_local tag_usage_node_t* tag_stack[SN_TAG_MAX_DEPTH];
+static plat_thread_local size_t tag_stack_depth = 0;
+
+tag_usage_node_t* sn_pri_current_tag()
+{
+    const size_t depth = tag_stack_depth;
+    return depth ? tag_stack[depth - 1] : NULL;
+}
+
+SN_PUB_API_OPEN
+sn_tag_t* sn_tag_create(const char* name, sn_tag_t* parent)
+{
+    if (!name)
+    {
+        sn_error(SN_ERR_NULL_PTR, NULL);
+    }
+
+    if (parent && parent->depth >= SN_TAG_MAX_DEPTH)
+    {
+        sn_error(SN_ERR_TAG_DEPTH, NULL);
+    }
+
+    tag_usage_node_t* node = tag_usage_getNode(tag_usage, parent, name);
+    if (!node)
+    {
+        sn_error(SN_ERR_BAD_ALLOC, NULL);
+    }
+    return node;
+}
+
+SN_PUB_API_OPEN
+SN_BOOL sn_tag_push(sn_tag_t* tag)
+{
+    if (!tag)
+    {
+        sn_error(SN_ERR_NULL_PTR, SN_FALSE);
+    }
+
+    if (tag_stack_depth >= SN_TAG_MAX_DEPTH)
+    {
+        sn_error(SN_ERR_TAG_DEPTH, SN_FALSE);
+    }
+
+    tag_stack[tag_stack_depth++] = tag;
+    return SN_TRUE;
+}
+
+SN_PUB_API_OPEN
+void sn_tag_pop()
+{
+    if (tag_stack_depth) tag_stack_depth--;
+}
+
+SN_PUB_API_OPEN
+sn_tag_t* sn_tag_current()
+{
+    return sn_pri_current_tag();
+}
+
+SN_PUB_API_OPEN
+void sn_tag_set_limit(sn_tag_t* tag, size_t limit)
+{
+    if (!tag)
+    {
+        sn_error(SN_ERR_NULL_PTR);
+    }
+
+    // Only new charges are checked, a tag already past its new limit just refuses until it drops below
+    plat_atomic_store_relaxed(&tag->limit, limit);
+}
+
+SN_PUB_API_OPEN
+SN_BOOL sn_query_tag_usage(sn_tag_t* tag, sn_tag_usage_t* out)
+{
+    if (!tag || !out)
+    {
+        sn_error(SN_ERR_NULL_PTR, SN_FALSE);
+    }
+
+    out->tag = tag;
+    out->parent = tag->parent;
+    out->name = tag->name;
+    out->bytes = plat_atomic_load_relaxed(&tag->bytes);
+    out->blocks = plat_atomic_load_relaxed(&tag->blocks);
+    out->peak_bytes = plat_atomic_load_relaxed(&tag->peak_bytes);
+    out->limit = plat_atomic_load_relaxed(&tag->limit);
+    return SN_TRUE;
+}
+
+SN_PUB_API_OPEN
+size_t sn_query_all_tag_usage(sn_tag_usage_t* out, size_t max_count)
+{
+    return tag_usage_snapshot(tag_usage, out, max_count);
+}